@@ -1,13 +1,463 @@
 #include "draw_ref.h"
 #include "util.h"
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/classes/control.hpp>
+#include <godot_cpp/classes/window.hpp>
+#include <godot_cpp/classes/geometry2d.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 
 using namespace godot;
 
+// Segments of a full circle, scaled with its radius
+#define DRAW_CIRCLE_SEGMENTS(m_radius) CLAMP((int)((m_radius) * 0.5) + 8, 8, 64)
+// Fraction of the rate interval a redraw may come early, absorbs frame delta rounding
+#define DRAW_RATE_TOLERANCE 0.1
+// Width of the fading edge added around antialiased tessellated shapes
+#define DRAW_FEATHER 1.0
+
 void DrawRef::redraw() {
 	queued_redraw = false;
-	if (!draw_callable.is_null())
+	take_delta();
+	if (!draw_callable.is_null()) {
+		target = node->get_canvas_item();
 		draw_callable.call(this);
+		flush();
+		target = RID();
+	}
+}
+
+void DrawRef::record() {
+	// Resizing changes what most widgets draw, it invalidates the recording like a dependency
+	Control *control = Object::cast_to<Control>(node);
+	Vector2 size = control ? control->get_size() : Vector2();
+	if (!queued_redraw && size == cache_size) return;
+
+	queued_redraw = false;
+	take_delta();
+	cache_size = size;
+
+	if (batched) {
+		// Kept as local geometry, the batch owner transforms and submits it with its siblings
+		batch_points.clear();
+		batch_colors.clear();
+		batch_indices.clear();
+		batch_dirty = true;
+		if (!draw_callable.is_null()) {
+			batch_recording = true;
+			draw_callable.call(this);
+			batch_recording = false;
+		}
+		return;
+	}
+
+	RenderingServer::get_singleton()->canvas_item_clear(cache_item);
+	if (!draw_callable.is_null()) {
+		target = cache_item;
+		draw_callable.call(this);
+		flush();
+		target = RID();
+	}
+}
+
+void DrawRef::generate() {
+	// Worker thread, only touches the snapshot taken when the task was queued
+	generator_result = generator_callable.call(generator_time, generator_size);
+}
+
+void DrawRef::update_generator(bool p_allowed) {
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	RenderingServer *rs = RenderingServer::get_singleton();
+
+	if (generator_task != -1) {
+		// Double buffering keeps the previous geometry on screen until the new one is done, otherwise it's waited for
+		if (generator_double_buffer && !pool->is_task_completed(generator_task)) return;
+		pool->wait_for_task_completion(generator_task);
+		generator_task = -1;
+
+		Array result = generator_result;
+		generator_result = Array();
+		rs->canvas_item_clear(cache_item);
+		if (result.size() != 3) {
+			ERR_PRINT("Generator must return [points: PackedVector2Array, colors: PackedColorArray, indices: PackedInt32Array]");
+		} else {
+			PackedVector2Array points = result[0];
+			PackedColorArray colors = result[1];
+			PackedInt32Array indices = result[2];
+			if (!indices.is_empty()) rs->canvas_item_add_triangle_array(cache_item, indices, points, colors);
+		}
+	}
+
+	if (!p_allowed) return;
+
+	Control *control = Object::cast_to<Control>(node);
+	Vector2 size = control ? control->get_size() : Vector2();
+	if (!queued_redraw && !generator_continuous && size == cache_size) return;
+	if (draw_callable.is_null()) return;
+
+	queued_redraw = false;
+	take_delta();
+	cache_size = size;
+
+	generator_callable = draw_callable;
+	generator_time = time;
+	generator_size = size;
+	generator_task = pool->add_task(callable_mp(this, &DrawRef::generate), true, "Godui draw generator");
+}
+
+void DrawRef::batch_fan(const Vector2 &p_center, float p_radius, float p_from, float p_to, int p_segments, const Color &p_color) {
+	int32_t base = batch_points.size();
+	batch_points.push_back(p_center);
+	batch_colors.push_back(p_color);
+	for (int i = 0; i <= p_segments; i++) {
+		float a = p_from + (p_to - p_from) * (float)i / (float)p_segments;
+		batch_points.push_back(p_center + Vector2(Math::cos(a), Math::sin(a)) * p_radius);
+		batch_colors.push_back(p_color);
+	}
+	for (int i = 0; i < p_segments; i++) {
+		batch_indices.push_back(base);
+		batch_indices.push_back(base + 1 + i);
+		batch_indices.push_back(base + 2 + i);
+	}
+}
+
+void DrawRef::batch_quad(const Vector2 &p_a, const Vector2 &p_b, const Vector2 &p_c, const Vector2 &p_d, const Color &p_color) {
+	int32_t base = batch_points.size();
+	batch_points.push_back(p_a);
+	batch_points.push_back(p_b);
+	batch_points.push_back(p_c);
+	batch_points.push_back(p_d);
+	for (int i = 0; i < 4; i++) batch_colors.push_back(p_color);
+	batch_indices.push_back(base);
+	batch_indices.push_back(base + 1);
+	batch_indices.push_back(base + 2);
+	batch_indices.push_back(base);
+	batch_indices.push_back(base + 2);
+	batch_indices.push_back(base + 3);
+}
+
+void DrawRef::batch_feather(const LocalVector<Vector2> &p_outline, const Color &p_color) {
+	uint32_t count = p_outline.size();
+	if (count < 3) return;
+
+	// Winding decides which side of each edge is outside
+	float area = 0.0;
+	for (uint32_t i = 0; i < count; i++) area += p_outline[i].cross(p_outline[(i + 1) % count]);
+	float outward = area > 0.0 ? 1.0 : -1.0;
+
+	Color clear = Color(p_color.r, p_color.g, p_color.b, 0.0);
+	int32_t base = batch_points.size();
+	for (uint32_t i = 0; i < count; i++) {
+		Vector2 prev = p_outline[(i + count - 1) % count];
+		Vector2 cur = p_outline[i];
+		Vector2 next = p_outline[(i + 1) % count];
+		Vector2 normal = ((cur - prev).normalized().orthogonal() + (next - cur).normalized().orthogonal()).normalized() * outward;
+		batch_points.push_back(cur);
+		batch_points.push_back(cur + normal * DRAW_FEATHER);
+		batch_colors.push_back(p_color);
+		batch_colors.push_back(clear);
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		int32_t a = base + i * 2;
+		int32_t c = base + ((i + 1) % count) * 2;
+		batch_indices.push_back(a);
+		batch_indices.push_back(a + 1);
+		batch_indices.push_back(c + 1);
+		batch_indices.push_back(a);
+		batch_indices.push_back(c + 1);
+		batch_indices.push_back(c);
+	}
+}
+
+void DrawRef::flush() {
+	if (batched || batch_indices.is_empty()) return;
+
+	PackedVector2Array points;
+	PackedColorArray colors;
+	PackedInt32Array indices;
+	points.resize(batch_points.size());
+	colors.resize(batch_colors.size());
+	indices.resize(batch_indices.size());
+	memcpy(points.ptrw(), batch_points.ptr(), batch_points.size() * sizeof(Vector2));
+	memcpy(colors.ptrw(), batch_colors.ptr(), batch_colors.size() * sizeof(Color));
+	memcpy(indices.ptrw(), batch_indices.ptr(), batch_indices.size() * sizeof(int32_t));
+
+	RenderingServer::get_singleton()->canvas_item_add_triangle_array(target, indices, points, colors);
+
+	batch_points.clear();
+	batch_colors.clear();
+	batch_indices.clear();
+}
+
+void DrawRef::take_delta() {
+	delta = pending_delta;
+	pending_delta = 0.0;
+
+	// Frame deltas jitter around the rate interval, the remainder carries over instead of being dropped.
+	// After a long pause (culled, unfocused) the phase restarts so skipped redraws don't come in a burst
+	if (max_rate > 0.0) {
+		float interval = 1.0 / max_rate;
+		rate_phase = rate_phase >= interval * 2.0 ? 0.0 : rate_phase - interval;
+	} else {
+		rate_phase = 0.0;
+	}
+}
+
+bool DrawRef::is_redraw_allowed() const {
+	// Offscreen culling needs the owner's rect, UI::draw_update checks it last
+	if (max_rate > 0.0 && rate_phase < (1.0 - DRAW_RATE_TOLERANCE) / max_rate) return false;
+	if (cull_hidden && !node->is_visible_in_tree()) return false;
+	if (pause_unfocused) {
+		Window *window = node->get_window();
+		if (window && (!window->has_focus() || window->get_mode() == Window::MODE_MINIMIZED)) return false;
+	}
+	return true;
+}
+
+void DrawRef::line(const Vector2 &p_from, const Vector2 &p_to, const Color &p_color, float p_width, bool p_antialiased) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	if (batched) {
+		Vector2 offset = (p_to - p_from).normalized().orthogonal() * (p_width < 0.0 ? 0.5 : p_width * 0.5);
+		batch_quad(p_from + offset, p_to + offset, p_to - offset, p_from - offset, p_color);
+		return;
+	}
+	flush();
+	RenderingServer::get_singleton()->canvas_item_add_line(target, p_from, p_to, p_color, p_width, p_antialiased);
+}
+
+void DrawRef::rect(const Rect2 &p_rect, const Color &p_color, bool p_antialiased) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	if (batched) {
+		batch_quad(p_rect.position, Vector2(p_rect.position.x + p_rect.size.x, p_rect.position.y), p_rect.position + p_rect.size, Vector2(p_rect.position.x, p_rect.position.y + p_rect.size.y), p_color);
+		return;
+	}
+	flush();
+	RenderingServer::get_singleton()->canvas_item_add_rect(target, p_rect, p_color, p_antialiased);
+}
+
+void DrawRef::circle(const Vector2 &p_position, float p_radius, const Color &p_color, bool p_antialiased) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	if (batched) {
+		batch_fan(p_position, p_radius, 0.0, Math_TAU, DRAW_CIRCLE_SEGMENTS(p_radius), p_color);
+		return;
+	}
+	flush();
+	RenderingServer::get_singleton()->canvas_item_add_circle(target, p_position, p_radius, p_color, p_antialiased);
+}
+
+void DrawRef::polyline(const PackedVector2Array &p_points, const Color &p_color, float p_width, bool p_antialiased) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	if (batched) {
+		joined_polyline(p_points, p_color, p_width < 0.0 ? 1.0 : p_width);
+		return;
+	}
+	flush();
+	PackedColorArray colors;
+	colors.push_back(p_color);
+	RenderingServer::get_singleton()->canvas_item_add_polyline(target, p_points, colors, p_width, p_antialiased);
+}
+
+void DrawRef::polygon(const PackedVector2Array &p_points, const Color &p_color) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	if (batched) {
+		PackedInt32Array triangles = Geometry2D::get_singleton()->triangulate_polygon(p_points);
+		int32_t base = batch_points.size();
+		for (int64_t i = 0; i < p_points.size(); i++) {
+			batch_points.push_back(p_points[i]);
+			batch_colors.push_back(p_color);
+		}
+		for (int64_t i = 0; i < triangles.size(); i++) batch_indices.push_back(base + triangles[i]);
+		return;
+	}
+	flush();
+	PackedColorArray colors;
+	colors.push_back(p_color);
+	RenderingServer::get_singleton()->canvas_item_add_polygon(target, p_points, colors);
+}
+
+void DrawRef::set_transform(const Transform2D &p_transform) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	ERR_FAIL_COND_MSG(batched, "Batched draws are placed by their node's transform");
+	flush();
+	RenderingServer::get_singleton()->canvas_item_add_set_transform(target, p_transform);
+}
+
+void DrawRef::capped_arc(const Vector2 &p_center, float p_radius, float p_start, float p_end, int p_point_count, const Color &p_color, float p_width, bool p_antialiased) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	ERR_FAIL_COND_MSG(p_point_count < 2, "Point count must be at least 2");
+	if (p_end < p_start) SWAP(p_start, p_end);
+
+	float hw = p_width * 0.5;
+	int segments = p_point_count - 1;
+
+	// Ring strip, consecutive quads share their edges
+	for (int i = 0; i < segments; i++) {
+		float a0 = p_start + (p_end - p_start) * (float)i / (float)segments;
+		float a1 = p_start + (p_end - p_start) * (float)(i + 1) / (float)segments;
+		Vector2 d0 = Vector2(Math::cos(a0), Math::sin(a0));
+		Vector2 d1 = Vector2(Math::cos(a1), Math::sin(a1));
+		batch_quad(p_center + d0 * (p_radius - hw), p_center + d0 * (p_radius + hw), p_center + d1 * (p_radius + hw), p_center + d1 * (p_radius - hw), p_color);
+	}
+
+	// Half discs facing away from the arc, so translucent colors don't overlap
+	int cap_segments = MAX(DRAW_CIRCLE_SEGMENTS(hw) / 2, 4);
+	batch_fan(p_center + Vector2(Math::cos(p_start), Math::sin(p_start)) * p_radius, hw, p_start + Math_PI, p_start + Math_TAU, cap_segments, p_color);
+	batch_fan(p_center + Vector2(Math::cos(p_end), Math::sin(p_end)) * p_radius, hw, p_end, p_end + Math_PI, cap_segments, p_color);
+
+	if (!p_antialiased) return;
+
+	// Same vertices as the fill's boundary: outer arc, end cap, inner arc back, start cap
+	LocalVector<Vector2> outline;
+	Vector2 start_center = p_center + Vector2(Math::cos(p_start), Math::sin(p_start)) * p_radius;
+	Vector2 end_center = p_center + Vector2(Math::cos(p_end), Math::sin(p_end)) * p_radius;
+	for (int i = 0; i <= segments; i++) {
+		float a = p_start + (p_end - p_start) * (float)i / (float)segments;
+		outline.push_back(p_center + Vector2(Math::cos(a), Math::sin(a)) * (p_radius + hw));
+	}
+	for (int i = 1; i < cap_segments; i++) {
+		float a = p_end + Math_PI * (float)i / (float)cap_segments;
+		outline.push_back(end_center + Vector2(Math::cos(a), Math::sin(a)) * hw);
+	}
+	for (int i = segments; i >= 0; i--) {
+		float a = p_start + (p_end - p_start) * (float)i / (float)segments;
+		outline.push_back(p_center + Vector2(Math::cos(a), Math::sin(a)) * (p_radius - hw));
+	}
+	for (int i = 1; i < cap_segments; i++) {
+		float a = p_start + Math_PI + Math_PI * (float)i / (float)cap_segments;
+		outline.push_back(start_center + Vector2(Math::cos(a), Math::sin(a)) * hw);
+	}
+	batch_feather(outline, p_color);
+}
+
+void DrawRef::rounded_rect(const Rect2 &p_rect, const Color &p_color, float p_radius, int p_corner_points) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	ERR_FAIL_COND_MSG(p_corner_points < 1, "Corner point count must be at least 1");
+
+	float r = CLAMP(p_radius, 0.0, MIN(p_rect.size.x, p_rect.size.y) * 0.5);
+	Vector2 a = p_rect.position + Vector2(r, r);
+	Vector2 b = p_rect.position + p_rect.size - Vector2(r, r);
+	Vector2 corners[4] = { Vector2(b.x, b.y), Vector2(a.x, b.y), Vector2(a.x, a.y), Vector2(b.x, a.y) };
+
+	// Convex, so a single fan around the center covers it
+	int32_t base = batch_points.size();
+	batch_points.push_back(p_rect.get_center());
+	batch_colors.push_back(p_color);
+	for (int c = 0; c < 4; c++) {
+		for (int i = 0; i <= p_corner_points; i++) {
+			float angle = Math_PI * 0.5 * ((float)c + (float)i / (float)p_corner_points);
+			batch_points.push_back(corners[c] + Vector2(Math::cos(angle), Math::sin(angle)) * r);
+			batch_colors.push_back(p_color);
+		}
+	}
+	int32_t rim = 4 * (p_corner_points + 1);
+	for (int32_t i = 0; i < rim; i++) {
+		batch_indices.push_back(base);
+		batch_indices.push_back(base + 1 + i);
+		batch_indices.push_back(base + 1 + (i + 1) % rim);
+	}
+}
+
+void DrawRef::joined_polyline(const PackedVector2Array &p_points, const Color &p_color, float p_width, float p_miter_limit) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	ERR_FAIL_COND_MSG(p_miter_limit <= 0.0, "Miter limit must be greater than 0");
+	int64_t count = p_points.size();
+	if (count < 2) return;
+
+	float hw = p_width * 0.5;
+	const Vector2 *pts = p_points.ptr();
+
+	// Each segment ends at its joint's shared corners, so neighbouring quads meet without overlapping
+	Vector2 start_normal = (pts[1] - pts[0]).normalized().orthogonal() * hw;
+	Vector2 start_a = pts[0] + start_normal;
+	Vector2 start_b = pts[0] - start_normal;
+	for (int64_t i = 0; i < count - 1; i++) {
+		Vector2 dir = (pts[i + 1] - pts[i]).normalized();
+		Vector2 normal = dir.orthogonal();
+		Vector2 end_a = pts[i + 1] + normal * hw;
+		Vector2 end_b = pts[i + 1] - normal * hw;
+		Vector2 next_a = end_a;
+		Vector2 next_b = end_b;
+
+		if (i + 2 < count) {
+			Vector2 next_dir = (pts[i + 2] - pts[i + 1]).normalized();
+			Vector2 next_normal = next_dir.orthogonal();
+			Vector2 miter = (normal + next_normal).normalized();
+			float denom = miter.dot(next_normal);
+
+			if (denom > 1.0 / p_miter_limit) {
+				end_a = next_a = pts[i + 1] + miter * (hw / denom);
+				end_b = next_b = pts[i + 1] - miter * (hw / denom);
+			} else {
+				// Too sharp, bevel the outer side of the turn
+				float side = dir.cross(next_dir) > 0.0 ? 1.0 : -1.0;
+				Vector2 outer_end = pts[i + 1] + normal * (hw * side);
+				Vector2 outer_next = pts[i + 1] + next_normal * (hw * side);
+				Vector2 inner_end = pts[i + 1] - normal * (hw * side);
+				Vector2 inner_next = pts[i + 1] - next_normal * (hw * side);
+				Vector2 pivot = pts[i + 1];
+
+				// The inner side meets at the miter point while it stays within half of both segments,
+				// past that (very short segments) the two quads still overlap there
+				float reach = MIN(pts[i].distance_to(pts[i + 1]), pts[i + 1].distance_to(pts[i + 2])) * 0.5;
+				if (hw * Math::sqrt(MAX(1.0 - denom * denom, 0.0)) < denom * reach) {
+					inner_end = inner_next = pivot = pts[i + 1] - miter * (hw * side / denom);
+				}
+
+				int32_t base = batch_points.size();
+				batch_points.push_back(pivot);
+				batch_points.push_back(outer_end);
+				batch_points.push_back(outer_next);
+				for (int j = 0; j < 3; j++) batch_colors.push_back(p_color);
+				for (int j = 0; j < 3; j++) batch_indices.push_back(base + j);
+
+				end_a = side > 0.0 ? outer_end : inner_end;
+				end_b = side > 0.0 ? inner_end : outer_end;
+				next_a = side > 0.0 ? outer_next : inner_next;
+				next_b = side > 0.0 ? inner_next : outer_next;
+			}
+		}
+
+		batch_quad(start_a, end_a, end_b, start_b, p_color);
+		start_a = next_a;
+		start_b = next_b;
+	}
+}
+
+void DrawRef::circles(const PackedVector2Array &p_positions, const PackedFloat32Array &p_radii, const PackedColorArray &p_colors) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	int64_t count = p_positions.size();
+	ERR_FAIL_COND_MSG(p_radii.size() != 1 && p_radii.size() != count, "Radii must have one value or one per circle");
+	ERR_FAIL_COND_MSG(p_colors.size() != 1 && p_colors.size() != count, "Colors must have one value or one per circle");
+
+	const Vector2 *pos = p_positions.ptr();
+	const float *radii = p_radii.ptr();
+	const Color *colors = p_colors.ptr();
+	bool per_radius = p_radii.size() > 1;
+	bool per_color = p_colors.size() > 1;
+
+	for (int64_t i = 0; i < count; i++) {
+		float r = radii[per_radius ? i : 0];
+		batch_fan(pos[i], r, 0.0, Math_TAU, DRAW_CIRCLE_SEGMENTS(r), colors[per_color ? i : 0]);
+	}
+}
+
+void DrawRef::rects(const PackedVector2Array &p_positions, const PackedVector2Array &p_sizes, const PackedColorArray &p_colors) {
+	ERR_FAIL_COND_MSG(!is_drawing(), "Can only draw inside the draw callable");
+	int64_t count = p_positions.size();
+	ERR_FAIL_COND_MSG(p_sizes.size() != 1 && p_sizes.size() != count, "Sizes must have one value or one per rect");
+	ERR_FAIL_COND_MSG(p_colors.size() != 1 && p_colors.size() != count, "Colors must have one value or one per rect");
+
+	const Vector2 *pos = p_positions.ptr();
+	const Vector2 *sizes = p_sizes.ptr();
+	const Color *colors = p_colors.ptr();
+	bool per_size = p_sizes.size() > 1;
+	bool per_color = p_colors.size() > 1;
+
+	for (int64_t i = 0; i < count; i++) {
+		Vector2 a = pos[i];
+		Vector2 b = a + sizes[per_size ? i : 0];
+		batch_quad(a, Vector2(b.x, a.y), b, Vector2(a.x, b.y), colors[per_color ? i : 0]);
+	}
 }
 
 void DrawRef::_bind_methods() {
@@ -15,6 +465,17 @@ void DrawRef::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_delta"), &DrawRef::get_delta);
 	ClassDB::bind_method(D_METHOD("get_node"), &DrawRef::get_node);
 	ClassDB::bind_method(D_METHOD("redraw"), &DrawRef::queue_redraw);
+	ClassDB::bind_method(D_METHOD("line", "from", "to", "color", "width", "antialiased"), &DrawRef::line, DEFVAL(-1.0), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("rect", "rect", "color", "antialiased"), &DrawRef::rect, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("circle", "position", "radius", "color", "antialiased"), &DrawRef::circle, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("polyline", "points", "color", "width", "antialiased"), &DrawRef::polyline, DEFVAL(-1.0), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("polygon", "points", "color"), &DrawRef::polygon);
+	ClassDB::bind_method(D_METHOD("set_transform", "transform"), &DrawRef::set_transform);
+	ClassDB::bind_method(D_METHOD("capped_arc", "center", "radius", "start_angle", "end_angle", "point_count", "color", "width", "antialiased"), &DrawRef::capped_arc, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("rounded_rect", "rect", "color", "radius", "corner_points"), &DrawRef::rounded_rect, DEFVAL(8));
+	ClassDB::bind_method(D_METHOD("joined_polyline", "points", "color", "width", "miter_limit"), &DrawRef::joined_polyline, DEFVAL(4.0));
+	ClassDB::bind_method(D_METHOD("circles", "positions", "radii", "colors"), &DrawRef::circles);
+	ClassDB::bind_method(D_METHOD("rects", "positions", "sizes", "colors"), &DrawRef::rects);
 	ClassDB::add_property("DrawRef", PropertyInfo(Variant::FLOAT, "time"), "", "get_time");
 	ClassDB::add_property("DrawRef", PropertyInfo(Variant::FLOAT, "delta"), "", "get_delta");
 	ClassDB::add_property("DrawRef", PropertyInfo(Variant::OBJECT, "node", PROPERTY_HINT_RESOURCE_TYPE, "CanvasItem"), "", "get_node");
@@ -25,9 +486,48 @@ DrawRef::DrawRef() {
 
 	time = 0.0;
 	delta = 0.0;
+	pending_delta = 0.0;
+	rate_phase = 0.0;
+	queued_redraw = false;
+
+	max_rate = 0.0;
+	cull_hidden = false;
+	cull_offscreen = false;
+	pause_unfocused = false;
 	draw_callable = Callable();
+
+	target = RID();
+	cache_item = RID();
+	cache_dependencies = Array();
+	cache_size = Vector2();
+
+	batch_points = LocalVector<Vector2>();
+	batch_colors = LocalVector<Color>();
+	batch_indices = LocalVector<int32_t>();
+	generator_callable = Callable();
+	generator_result = Array();
+	generator_task = -1;
+	generator_time = 0.0;
+	generator_size = Vector2();
+	threaded = false;
+	generator_continuous = false;
+	generator_double_buffer = true;
+
+	batch_transform = Transform2D();
+	batched = false;
+	batch_recording = false;
+	batch_dirty = false;
+	batch_visible = false;
 }
 
+DrawRef::~DrawRef() {
+	if (generator_task != -1) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(generator_task);
+	}
+	if (cache_item.is_valid()) {
+		RenderingServer::get_singleton()->free_rid(cache_item);
+	}
+}
 
 
 
@@ -3,6 +3,11 @@
 
 #include <godot_cpp/variant/rid.hpp>
 #include <godot_cpp/variant/callable.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_color_array.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/classes/canvas_item.hpp>
 
@@ -19,14 +24,65 @@ class DrawRef : public RefCounted {
 
 	float time;
 	float delta;
+	float pending_delta;
+	float rate_phase;
 	bool queued_redraw;
 
+	// Redraw policy, skipped redraws stay queued and their time is folded into the next delta
+	float max_rate;
+	bool cull_hidden;
+	bool cull_offscreen;
+	bool pause_unfocused;
+
 	Callable draw_callable;
 
+	// Canvas item receiving the primitives, only valid while the draw callable runs
+	RID target;
+
+	// Cached mode records into a child canvas item that the renderer keeps until invalidated
+	RID cache_item;
+	Array cache_dependencies;
+	Vector2 cache_size;
+
+	// Tessellated batched primitives, submitted as a single triangle array
+	LocalVector<Vector2> batch_points;
+	LocalVector<Color> batch_colors;
+	LocalVector<int32_t> batch_indices;
+
+	// Threaded mode runs the draw callable on the WorkerThreadPool, only submitting its buffers happens in draw_update
+	Callable generator_callable;
+	Array generator_result;
+	int64_t generator_task;
+	float generator_time;
+	Vector2 generator_size;
+	bool threaded;
+	bool generator_continuous;
+	bool generator_double_buffer;
+
+	void generate();
+	void update_generator(bool p_allowed);
+
+	// Batched mode keeps the geometry to be merged into a container's canvas item by UI::draw_batch_update
+	Transform2D batch_transform;
+	bool batched;
+	bool batch_recording;
+	bool batch_dirty;
+	bool batch_visible;
+
+	inline bool is_drawing() const { return target.is_valid() || batch_recording; }
+
+	void batch_fan(const Vector2 &p_center, float p_radius, float p_from, float p_to, int p_segments, const Color &p_color);
+	void batch_quad(const Vector2 &p_a, const Vector2 &p_b, const Vector2 &p_c, const Vector2 &p_d, const Color &p_color);
+	void batch_feather(const LocalVector<Vector2> &p_outline, const Color &p_color);
+	void flush();
+
 protected:
 	static void _bind_methods();
 	
 	void redraw();
+	void record();
+	void take_delta();
+	bool is_redraw_allowed() const;
 
 public:
 	inline float get_time() const { return this->time; }
@@ -35,7 +91,21 @@ public:
 	
 	inline void queue_redraw() { queued_redraw = true; }
 
+	void line(const Vector2 &p_from, const Vector2 &p_to, const Color &p_color, float p_width = -1.0, bool p_antialiased = false);
+	void rect(const Rect2 &p_rect, const Color &p_color, bool p_antialiased = false);
+	void circle(const Vector2 &p_position, float p_radius, const Color &p_color, bool p_antialiased = false);
+	void polyline(const PackedVector2Array &p_points, const Color &p_color, float p_width = -1.0, bool p_antialiased = false);
+	void polygon(const PackedVector2Array &p_points, const Color &p_color);
+	void set_transform(const Transform2D &p_transform);
+
+	void capped_arc(const Vector2 &p_center, float p_radius, float p_start, float p_end, int p_point_count, const Color &p_color, float p_width, bool p_antialiased = false);
+	void rounded_rect(const Rect2 &p_rect, const Color &p_color, float p_radius, int p_corner_points = 8);
+	void joined_polyline(const PackedVector2Array &p_points, const Color &p_color, float p_width, float p_miter_limit = 4.0);
+	void circles(const PackedVector2Array &p_positions, const PackedFloat32Array &p_radii, const PackedColorArray &p_colors);
+	void rects(const PackedVector2Array &p_positions, const PackedVector2Array &p_sizes, const PackedColorArray &p_colors);
+
 	DrawRef();
+	~DrawRef();
 };
 
 }
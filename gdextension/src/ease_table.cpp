@@ -0,0 +1,262 @@
+#include "ease_table.h"
+#include "motion_ref.h"
+#include <godot_cpp/core/math.hpp>
+
+using namespace godot;
+
+// Upper bound for the adaptive resolution, tables never grow past 16KiB
+#define EASE_TABLE_MAX_RESOLUTION 4096
+// Starting resolution of custom curves when builtin easing baking is disabled
+#define EASE_TABLE_CUSTOM_RESOLUTION 64
+// Tables kept cached, the least recently used one is dropped past this
+#define EASE_TABLE_MAX_CACHED 512
+
+HashMap<EaseTable::Key, EaseTable *, EaseTable::Key> EaseTable::cache = HashMap<EaseTable::Key, EaseTable *, EaseTable::Key>();
+uint64_t EaseTable::use_tick = 0;
+BinaryMutex EaseTable::mutex;
+
+uint32_t EaseTable::bake_resolution = 0;
+float EaseTable::bake_error_bound = 0.001;
+bool EaseTable::bake_cubic = true;
+
+float EaseTable::evaluate(const Key &p_key, const Ref<Curve> &p_curve, float p_time) {
+	switch (p_key.type) {
+		case 12: { // Cubic bezier
+			float t = bezier_solve(p_key.params[0], p_key.params[2], p_time);
+			float u = 1.0 - t;
+			return 3.0 * u * u * t * p_key.params[1] + 3.0 * u * t * t * p_key.params[3] + t * t * t;
+		}
+		case 13: // Curve, params 2 and 3 hold its domain
+			return p_curve->sample(p_key.params[2] + (p_key.params[3] - p_key.params[2]) * p_time);
+		default:
+			return MotionRef::eval_time(p_key.type, p_time, p_key.params[0]);
+	}
+}
+
+float EaseTable::bezier_solve(float p_x1, float p_x2, float p_x) {
+	// Finds the curve parameter of x, x(t) is monotonic as both control points are clamped to [0, 1]
+	float t = p_x;
+	for (int i = 0; i < 8; i++) {
+		float u = 1.0 - t;
+		float x = 3.0 * u * u * t * p_x1 + 3.0 * u * t * t * p_x2 + t * t * t - p_x;
+		float dx = 3.0 * u * u * p_x1 + 6.0 * u * t * (p_x2 - p_x1) + 3.0 * t * t * (1.0 - p_x2);
+		if (ABS(x) < 1e-6) return t;
+		if (ABS(dx) < 1e-6) break;
+		t -= x / dx;
+	}
+
+	// Newton didn't converge (flat slope), fall back to bisection
+	float lo = 0.0, hi = 1.0;
+	t = p_x;
+	for (int i = 0; i < 32; i++) {
+		float u = 1.0 - t;
+		float x = 3.0 * u * u * t * p_x1 + 3.0 * u * t * t * p_x2 + t * t * t;
+		if (ABS(x - p_x) < 1e-6) break;
+		if (x < p_x) lo = t; else hi = t;
+		t = (lo + hi) * 0.5;
+	}
+	return t;
+}
+
+void EaseTable::bake(const Key &p_key, const Ref<Curve> &p_curve, uint32_t p_resolution) {
+	samples.resize(p_resolution);
+	float *w = samples.ptrw();
+	for (uint32_t i = 0; i < p_resolution; i++) {
+		w[i] = evaluate(p_key, p_curve, (float)i / (float)(p_resolution - 1));
+	}
+	last = (float)(p_resolution - 1);
+}
+
+float EaseTable::max_error(const Key &p_key, const Ref<Curve> &p_curve) const {
+	// Midpoints between samples are where the interpolation deviates the most
+	float err = 0.0;
+	for (int64_t i = 0; i < samples.size() - 1; i++) {
+		float t = ((float)i + 0.5) / last;
+		float e = ABS(sample(t) - evaluate(p_key, p_curve, t));
+		if (e > err) err = e;
+	}
+	return err;
+}
+
+float EaseTable::sample(float p_time) const {
+	float x = (p_time < 0.0 ? 0.0 : (p_time > 1.0 ? 1.0 : p_time)) * last;
+	int64_t i = (int64_t)x;
+	if (i >= samples.size() - 1) return samples[samples.size() - 1];
+
+	const float *r = samples.ptr();
+	float f = x - (float)i;
+
+	if (!cubic) return r[i] + (r[i + 1] - r[i]) * f;
+
+	// Catmull-Rom between samples i and i + 1, clamping the outer neighbours
+	float p0 = r[i == 0 ? 0 : i - 1];
+	float p1 = r[i];
+	float p2 = r[i + 1];
+	float p3 = r[i + 2 < samples.size() ? i + 2 : i + 1];
+	return p1 + 0.5 * f * (p2 - p0 + f * (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3 + f * (3.0 * (p1 - p2) + p3 - p0)));
+}
+
+void EaseTable::unreference(const EaseTable *p_table) {
+	if (p_table && p_table->refs.unref()) memdelete(const_cast<EaseTable *>(p_table));
+}
+
+const EaseTable *EaseTable::find(const Key &p_key, const Vector<float> &p_source) {
+	HashMap<Key, EaseTable *, Key>::Iterator it = cache.find(p_key);
+	if (!it || it->value->source != p_source) return nullptr;
+	it->value->last_used = ++use_tick;
+	it->value->reference();
+	return it->value;
+}
+
+void EaseTable::insert(const Key &p_key, EaseTable *p_table) {
+	HashMap<Key, EaseTable *, Key>::Iterator it = cache.find(p_key);
+	if (it) {
+		// Same hash, different content, the newer one takes the slot
+		unreference(it->value);
+		it->value = p_table;
+	} else {
+		if (cache.size() >= EASE_TABLE_MAX_CACHED) {
+			HashMap<Key, EaseTable *, Key>::Iterator oldest = cache.begin();
+			for (HashMap<Key, EaseTable *, Key>::Iterator e = cache.begin(); e; ++e) {
+				if (e->value->last_used < oldest->value->last_used) oldest = e;
+			}
+			Key evicted = oldest->key;
+			unreference(oldest->value);
+			cache.erase(evicted);
+		}
+		cache.insert(p_key, p_table);
+	}
+	p_table->last_used = ++use_tick;
+	// One reference for the cache from 'refs.init', one for the caller
+	p_table->reference();
+}
+
+const EaseTable *EaseTable::get_or_bake(Key &p_key, const Ref<Curve> &p_curve, uint32_t p_resolution, const Vector<float> &p_source) {
+	p_key.resolution = p_resolution;
+	p_key.error_bound = bake_error_bound;
+	p_key.cubic = bake_cubic;
+
+	const EaseTable *cached = find(p_key, p_source);
+	if (cached) return cached;
+
+	EaseTable *table = memnew(EaseTable);
+	table->cubic = bake_cubic;
+	table->source = p_source;
+
+	uint32_t resolution = p_resolution < 2 ? 2 : p_resolution;
+	table->bake(p_key, p_curve, resolution);
+	while (bake_error_bound > 0.0 && resolution < EASE_TABLE_MAX_RESOLUTION && table->max_error(p_key, p_curve) > bake_error_bound) {
+		resolution = MIN(resolution * 2, (uint32_t)EASE_TABLE_MAX_RESOLUTION);
+		table->bake(p_key, p_curve, resolution);
+	}
+
+	insert(p_key, table);
+	return table;
+}
+
+const EaseTable *EaseTable::get(uint8_t p_type, float p_strength) {
+	MutexLock lock(mutex);
+	// Constant and linear are cheaper to evaluate than to sample
+	if (bake_resolution == 0 || p_type <= 1) return nullptr;
+
+	Key key;
+	key.type = p_type;
+	key.params[0] = p_strength;
+	return get_or_bake(key, Ref<Curve>(), bake_resolution);
+}
+
+const EaseTable *EaseTable::get_bezier(float p_x1, float p_y1, float p_x2, float p_y2) {
+	Key key;
+	key.type = 12;
+	key.params[0] = CLAMP(p_x1, 0.0, 1.0);
+	key.params[1] = p_y1;
+	key.params[2] = CLAMP(p_x2, 0.0, 1.0);
+	key.params[3] = p_y2;
+	MutexLock lock(mutex);
+	return get_or_bake(key, Ref<Curve>(), bake_resolution > 0 ? bake_resolution : EASE_TABLE_CUSTOM_RESOLUTION);
+}
+
+const EaseTable *EaseTable::get_curve(const Ref<Curve> &p_curve) {
+	ERR_FAIL_COND_V(p_curve.is_null(), nullptr);
+
+	// Keyed by the curve's content so edited curves get baked again and equal curves are shared
+	Vector<float> source;
+	int count = p_curve->get_point_count();
+	source.resize(4 + count * 6);
+	float *w = source.ptrw();
+	w[0] = p_curve->get_min_value();
+	w[1] = p_curve->get_max_value();
+	w[2] = p_curve->get_min_domain();
+	w[3] = p_curve->get_max_domain();
+	for (int i = 0; i < count; i++) {
+		Vector2 pos = p_curve->get_point_position(i);
+		float *point = w + 4 + i * 6;
+		point[0] = pos.x;
+		point[1] = pos.y;
+		point[2] = p_curve->get_point_left_tangent(i);
+		point[3] = p_curve->get_point_right_tangent(i);
+		point[4] = (float)p_curve->get_point_left_mode(i);
+		point[5] = (float)p_curve->get_point_right_mode(i);
+	}
+
+	Key key;
+	key.type = 13;
+	uint32_t h = hash_murmur3_one_32(count);
+	for (int64_t i = 0; i < source.size(); i++) h = hash_murmur3_one_float(w[i], h);
+	key.curve_hash = hash_fmix32(h);
+	for (int i = 0; i < 4; i++) key.params[i] = w[i];
+	MutexLock lock(mutex);
+	return get_or_bake(key, p_curve, bake_resolution > 0 ? bake_resolution : EASE_TABLE_CUSTOM_RESOLUTION, source);
+}
+
+const EaseTable *EaseTable::get_baked(uint8_t p_type, const Vector<float> &p_samples, bool p_cubic) {
+	ERR_FAIL_COND_V(p_samples.size() < 2, nullptr);
+
+	// Already baked samples (e.g. loaded from a MotionTimeline), keyed by their content
+	Key key;
+	key.type = p_type;
+	uint32_t h = hash_murmur3_one_32(p_samples.size());
+	for (int64_t i = 0; i < p_samples.size(); i++) h = hash_murmur3_one_float(p_samples[i], h);
+	key.curve_hash = hash_fmix32(h);
+	key.resolution = p_samples.size();
+	key.error_bound = -1.0;
+	key.cubic = p_cubic;
+
+	MutexLock lock(mutex);
+	const EaseTable *cached = find(key, p_samples);
+	if (cached) return cached;
+
+	EaseTable *table = memnew(EaseTable);
+	table->samples = p_samples;
+	table->source = p_samples;
+	table->last = (float)(p_samples.size() - 1);
+	table->cubic = p_cubic;
+
+	insert(key, table);
+	return table;
+}
+
+void EaseTable::set_baking(uint32_t p_resolution, float p_error_bound, bool p_cubic) {
+	// Tables already referenced by keyframes stay cached, the settings are part of the key
+	MutexLock lock(mutex);
+	bake_resolution = p_resolution;
+	bake_error_bound = p_error_bound;
+	bake_cubic = p_cubic;
+}
+
+void EaseTable::clear_cache() {
+	MutexLock lock(mutex);
+	for (HashMap<Key, EaseTable *, Key>::Iterator it = cache.begin(); it; ++it) {
+		unreference(it->value);
+	}
+	cache.clear();
+}
+
+EaseTable::EaseTable() {
+	samples = Vector<float>();
+	last = 0.0;
+	cubic = false;
+	refs.init();
+	last_used = 0;
+	source = Vector<float>();
+}
\ No newline at end of file
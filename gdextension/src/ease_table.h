@@ -0,0 +1,97 @@
+#ifndef GODUI_EASE_TABLE_H
+#define GODUI_EASE_TABLE_H
+
+#include <godot_cpp/templates/vector.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hashfuncs.hpp>
+#include <godot_cpp/templates/safe_refcount.hpp>
+#include <godot_cpp/core/mutex.hpp>
+#include <godot_cpp/classes/curve.hpp>
+
+namespace godot {
+
+class EaseTable {
+	struct Key {
+		uint8_t type;
+		float params[4];
+		uint32_t curve_hash;
+		uint32_t resolution;
+		float error_bound;
+		bool cubic;
+
+		static inline uint32_t hash(const Key &p_key) {
+			uint32_t h = hash_murmur3_one_32(p_key.type);
+			for (int i = 0; i < 4; i++) h = hash_murmur3_one_float(p_key.params[i], h);
+			h = hash_murmur3_one_32(p_key.curve_hash, h);
+			h = hash_murmur3_one_32(p_key.resolution, h);
+			h = hash_murmur3_one_float(p_key.error_bound, h);
+			h = hash_murmur3_one_32(p_key.cubic, h);
+			return hash_fmix32(h);
+		}
+
+		inline bool operator==(const Key &p_other) const {
+			return type == p_other.type && params[0] == p_other.params[0] && params[1] == p_other.params[1] &&
+				params[2] == p_other.params[2] && params[3] == p_other.params[3] && curve_hash == p_other.curve_hash &&
+				resolution == p_other.resolution && error_bound == p_other.error_bound &&
+				cubic == p_other.cubic;
+		}
+
+		inline Key() {
+			type = 0;
+			params[0] = params[1] = params[2] = params[3] = 0.0;
+			curve_hash = 0;
+			resolution = 0;
+			error_bound = 0.0;
+			cubic = false;
+		}
+	};
+
+	// Resources decoded on loader threads intern their tables while the main thread builds keyframes
+	static HashMap<Key, EaseTable *, Key> cache;
+	static uint64_t use_tick;
+	static BinaryMutex mutex;
+
+	static uint32_t bake_resolution;
+	static float bake_error_bound;
+	static bool bake_cubic;
+
+	Vector<float> samples;
+	float last;
+	bool cubic;
+
+	// The cache holds one reference and keyframes one each, so evicted tables live until no keyframe uses them
+	mutable SafeRefCount refs;
+	uint64_t last_used;
+	// Exact content the key was hashed from, a hash collision is a miss rather than a wrong table
+	Vector<float> source;
+
+	static float evaluate(const Key &p_key, const Ref<Curve> &p_curve, float p_time);
+	static float bezier_solve(float p_x1, float p_x2, float p_x);
+	static const EaseTable *get_or_bake(Key &p_key, const Ref<Curve> &p_curve, uint32_t p_resolution, const Vector<float> &p_source = Vector<float>());
+	static const EaseTable *find(const Key &p_key, const Vector<float> &p_source);
+	static void insert(const Key &p_key, EaseTable *p_table);
+
+	void bake(const Key &p_key, const Ref<Curve> &p_curve, uint32_t p_resolution);
+	float max_error(const Key &p_key, const Ref<Curve> &p_curve) const;
+
+public:
+	float sample(float p_time) const;
+	inline const Vector<float> &get_samples() const { return samples; }
+	inline bool is_cubic() const { return cubic; }
+	inline void reference() const { refs.ref(); }
+	static void unreference(const EaseTable *p_table);
+
+	// The returned table carries a reference for the caller, taken while locked so another thread can't evict it first
+	static const EaseTable *get(uint8_t p_type, float p_strength);
+	static const EaseTable *get_bezier(float p_x1, float p_y1, float p_x2, float p_y2);
+	static const EaseTable *get_curve(const Ref<Curve> &p_curve);
+	static const EaseTable *get_baked(uint8_t p_type, const Vector<float> &p_samples, bool p_cubic);
+	static void set_baking(uint32_t p_resolution, float p_error_bound, bool p_cubic);
+	static void clear_cache();
+
+	EaseTable();
+};
+
+}
+
+#endif // GODUI_EASE_TABLE_H
\ No newline at end of file
@@ -1,20 +1,73 @@
 #include "motion_ref.h"
+#include "ease_table.h"
+#include "motion_timeline.h"
 #include "util.h"
 #include <godot_cpp/core/math.hpp>
+#include <godot_cpp/classes/canvas_item.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/shader.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 
 using namespace godot;
 
-HashMap<String, MotionRef::PropertyTrack>::Iterator MotionRef::get_property_track(const String &p_name, bool p_indexed) {
+// Distance and speed under which a spring snaps to its goal and sleeps
+#define SPRING_EPSILON 0.0005
+
+HashMap<String, MotionRef::PropertyTrack>::Iterator MotionRef::get_property_track(const String &p_name, uint8_t p_target) {
 	HashMap<String, PropertyTrack>::Iterator track = property_tracks.find(p_name);
 	if (!track) {
 		track = property_tracks.insert(p_name, PropertyTrack());
-		track->value.indexed = p_indexed;
-		track->value.current_value = p_indexed ? node->get_indexed(NodePath(p_name)) : node->get(StringName(p_name));
+		track->value.target = p_target;
+		// Shared timelines have no node to read from, their tracks start at the first 'frame'
+		if (p_target == TARGET_SHADER_PARAMETER) {
+			track->value.parameter = StringName(p_name.substr(p_name.find(":") + 1));
+			track->value.current_value = get_shader_parameter(track->value.parameter);
+		} else if (p_target >= TARGET_VISUAL_POSITION) {
+			track->value.current_value = get_visual(p_target);
+		} else if (node) {
+			track->value.current_value = p_target == TARGET_INDEXED ? node->get_indexed(NodePath(p_name)) : node->get(StringName(p_name));
+		}
 	}
 	return track;
 }
 
+Variant MotionRef::get_visual(uint8_t p_target) const {
+	switch (p_target) {
+		case TARGET_VISUAL_POSITION: return visual_position;
+		case TARGET_VISUAL_ROTATION: return visual_rotation;
+		case TARGET_VISUAL_SCALE: return visual_scale;
+		case TARGET_VISUAL_MODULATE: return visual_modulate;
+		default: return Variant();
+	}
+}
+
+Transform2D MotionRef::get_visual_transform(const Vector2 &p_pivot) const {
+	// Rotates and scales around the pivot, then offsets
+	Transform2D tr = Transform2D(visual_rotation, visual_scale, 0.0, Vector2());
+	tr.set_origin(visual_position + p_pivot - tr.basis_xform(p_pivot));
+	return tr;
+}
+
+bool MotionRef::resolve_shader_material() {
+	// Resolved on every build, so swapping the node's material retargets the tracks
+	CanvasItem *canvas_item = Object::cast_to<CanvasItem>(node);
+	Ref<Material> material = canvas_item ? canvas_item->get_material() : Ref<Material>();
+	shader_material = Ref<ShaderMaterial>(Object::cast_to<ShaderMaterial>(material.ptr()));
+	shader_material_rid = shader_material.is_valid() ? shader_material->get_rid() : RID();
+	return shader_material.is_valid();
+}
+
+Variant MotionRef::get_shader_parameter(const StringName &p_parameter) const {
+	// Read back from the server, parameters written by tracks never reach the ShaderMaterial
+	RenderingServer *rs = RenderingServer::get_singleton();
+	Variant value = rs->material_get_param(shader_material_rid, p_parameter);
+	if (value.get_type() == Variant::NIL && shader_material->get_shader().is_valid()) {
+		value = rs->shader_get_parameter_default(shader_material->get_shader()->get_rid(), p_parameter);
+	}
+	return value;
+}
+
 void MotionRef::clear() {
 	key_time = 0.0;
 	key_duration = 0.0;
@@ -23,59 +76,446 @@ void MotionRef::clear() {
 	loop_enabled = false;
 	property_tracks.clear();
 	callback_track.clear();
+	callback_cursor = 0;
+	callback_cursor_dirty = true;
 	property_track = property_tracks.end();
+	sleeping = false;
+	// Springs keep their state across rebuilds, only the ones declared again survive 'prune_springs'
+	for (HashMap<String, SpringTrack>::Iterator spring = springs.begin(); spring; ++spring) {
+		spring->value.declared = false;
+	}
 }
 
-void MotionRef::animate() {
+void MotionRef::prune_springs() {
+	LocalVector<String> undeclared;
+	for (HashMap<String, SpringTrack>::Iterator spring = springs.begin(); spring; ++spring) {
+		if (!spring->value.declared) undeclared.push_back(spring->key);
+	}
+	for (uint32_t i = 0; i < undeclared.size(); i++) springs.erase(undeclared[i]);
+}
+
+void MotionRef::wake() {
+	sleeping = false;
 	for (HashMap<String, PropertyTrack>::Iterator track = property_tracks.begin(); track; ++track) {
-		uint64_t s = track->value.track.size();
-		if (s == 0) continue;
+		track->value.sleeping = false;
+	}
+}
+
+uint64_t MotionRef::seek_callbacks(float p_time) const {
+	// First callback at or after p_time, callbacks are kept sorted by time
+	uint64_t lo = 0;
+	uint64_t hi = callback_track.size();
+	while (lo < hi) {
+		uint64_t mid = (lo + hi) / 2;
+		if (callback_track[mid].time < p_time) lo = mid + 1; else hi = mid;
+	}
+	return lo;
+}
+
+bool MotionRef::fire_callbacks(uint64_t &r_cursor, float p_to, bool p_inclusive) {
+	uint64_t s = callback_track.size();
+	while (r_cursor < s) {
+		const CallbackKeyframe &key = callback_track[r_cursor];
+		if (p_inclusive ? key.time > p_to : key.time >= p_to) break;
 
-		uint64_t idx = 0;
-		for (uint64_t i = 0; i < s; i++) {
-			idx = i;
-			const PropertyKeyframe &key = track->value.track[i];
+		Callable target = key.target;
+		r_cursor++;
+		target.call();
 
-			float t = key.time + key.duration;
-			if (t > time) break;
+		// The callback moved the timeline ('reset', 'delay'...), the new state takes over
+		if (callback_cursor_dirty) return false;
+	}
+	return true;
+}
+
+void MotionRef::evaluate_track(const PropertyTrack &p_track, float p_time, Variant &r_value) {
+	int64_t s = p_track.size();
+	const float *ends = p_track.ends.ptr();
+
+	// First keyframe still running at p_time, or the last one once every keyframe is done
+	int64_t idx = s - 1;
+	if (p_track.sorted) {
+		int64_t lo = 0;
+		while (lo < idx) {
+			int64_t mid = (lo + idx) / 2;
+			if (ends[mid] > p_time) idx = mid; else lo = mid + 1;
+		}
+	} else {
+		for (int64_t i = 0; i < s; i++) {
+			if (ends[i] > p_time) {
+				idx = i;
+				break;
+			}
 		}
+	}
 
-		uint64_t prev_idx = idx == 0 ? 0 : idx - 1;
+	int64_t prev_idx = idx == 0 ? 0 : idx - 1;
 
-		const PropertyKeyframe &key0 = track->value.track[prev_idx];
-		const PropertyKeyframe &key1 = track->value.track[idx];
+	const KeyframeEase &ease = p_track.eases[idx];
+	float t = ease_keyframe(ease, p_time - ease.time);
 
-		// UtilityFunctions::print(vformat("%s, %s, %s, %s, %s, %s", key0.end_value, key1.value, key1.ease_type, key1.ease_strength, time - key1.time, key1.duration));
+	if (p_track.components == 0) {
+		interpolate_value(p_track.variant_end_values[prev_idx], p_track.variant_values[idx], t, r_value);
+		return;
+	}
 
-		Variant val;
-		transition_value(key0.end_value, key1.value, val, key1.ease_type, key1.ease_strength, time - key1.time, key1.duration);
-	
-		if (track->value.indexed) {
-			node->set_indexed(NodePath(track->key), val);
+	int64_t c = p_track.components;
+	const float *from = (p_track.has_end_values ? p_track.end_values.ptr() : p_track.values.ptr()) + prev_idx * c;
+	const float *to = p_track.values.ptr() + idx * c;
+	float out[4];
+	for (int64_t i = 0; i < c; i++) out[i] = from[i] + (to[i] - from[i]) * t;
+	r_value = unpack_value((Variant::Type)p_track.value_type, out);
+}
+
+void MotionRef::apply_track(Node *p_node, const String &p_name, uint8_t p_target, const StringName &p_parameter, const Variant &p_value) {
+	switch (p_target) {
+		case TARGET_PROPERTY: p_node->set(StringName(p_name), p_value); break;
+		case TARGET_INDEXED: p_node->set_indexed(NodePath(p_name), p_value); break;
+		// Visual channels are composed into the canvas item by UI::draw_update
+		case TARGET_VISUAL_POSITION: visual_position = p_value; break;
+		case TARGET_VISUAL_ROTATION: visual_rotation = p_value; break;
+		case TARGET_VISUAL_SCALE: visual_scale = p_value; break;
+		case TARGET_VISUAL_MODULATE: visual_modulate = p_value; break;
+		// Skips the material's property dispatch, the RID was resolved when the track was built
+		case TARGET_SHADER_PARAMETER: RenderingServer::get_singleton()->material_set_param(shader_material_rid, p_parameter, p_value); break;
+	}
+}
+
+void MotionRef::step_spring(SpringTrack &r_spring, float p_delta) {
+	// Exact critically damped solution, stable for any delta
+	float y = 2.0 * Math_LN2 / r_spring.half_life;
+	float eydt = Math::exp(-y * p_delta);
+	bool settled = true;
+
+	for (int i = 0; i < r_spring.components; i++) {
+		float j0 = r_spring.value[i] - r_spring.goal[i];
+		float j1 = r_spring.velocity[i] + j0 * y;
+		r_spring.value[i] = eydt * (j0 + j1 * p_delta) + r_spring.goal[i];
+		r_spring.velocity[i] = eydt * (r_spring.velocity[i] - j1 * y * p_delta);
+		if (ABS(r_spring.value[i] - r_spring.goal[i]) > SPRING_EPSILON || ABS(r_spring.velocity[i]) > SPRING_EPSILON) settled = false;
+	}
+
+	if (settled) {
+		for (int i = 0; i < r_spring.components; i++) {
+			r_spring.value[i] = r_spring.goal[i];
+			r_spring.velocity[i] = 0.0;
+		}
+	}
+	r_spring.settled = settled;
+	r_spring.result = unpack_value((Variant::Type)r_spring.value_type, r_spring.value);
+}
+
+uint8_t MotionRef::value_components(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::FLOAT: return 1;
+		case Variant::VECTOR2: return 2;
+		case Variant::VECTOR3: return 3;
+		case Variant::VECTOR4:
+		case Variant::QUATERNION:
+		case Variant::COLOR: return 4;
+		default: return 0;
+	}
+}
+
+void MotionRef::pack_value(const Variant &p_value, float *r_out) {
+	switch (p_value.get_type()) {
+		case Variant::INT:
+		case Variant::FLOAT: r_out[0] = p_value; break;
+		case Variant::VECTOR2: {
+			Vector2 v = p_value;
+			r_out[0] = v.x; r_out[1] = v.y;
+		} break;
+		case Variant::VECTOR3: {
+			Vector3 v = p_value;
+			r_out[0] = v.x; r_out[1] = v.y; r_out[2] = v.z;
+		} break;
+		case Variant::VECTOR4: {
+			Vector4 v = p_value;
+			r_out[0] = v.x; r_out[1] = v.y; r_out[2] = v.z; r_out[3] = v.w;
+		} break;
+		case Variant::QUATERNION: {
+			Quaternion v = p_value;
+			r_out[0] = v.x; r_out[1] = v.y; r_out[2] = v.z; r_out[3] = v.w;
+		} break;
+		case Variant::COLOR: {
+			Color v = p_value;
+			r_out[0] = v.r; r_out[1] = v.g; r_out[2] = v.b; r_out[3] = v.a;
+		} break;
+		default: break;
+	}
+}
+
+Variant MotionRef::unpack_value(Variant::Type p_type, const float *p_in) {
+	switch (p_type) {
+		case Variant::FLOAT: return p_in[0];
+		case Variant::VECTOR2: return Vector2(p_in[0], p_in[1]);
+		case Variant::VECTOR3: return Vector3(p_in[0], p_in[1], p_in[2]);
+		case Variant::VECTOR4: return Vector4(p_in[0], p_in[1], p_in[2], p_in[3]);
+		case Variant::QUATERNION: return Quaternion(p_in[0], p_in[1], p_in[2], p_in[3]);
+		case Variant::COLOR: return Color(p_in[0], p_in[1], p_in[2], p_in[3]);
+		default: return Variant();
+	}
+}
+
+void MotionRef::append_keyframe(PropertyTrack &r_track, const KeyframeEase &p_ease, const Variant &p_value, const Variant &p_end_value) {
+	int64_t idx = r_track.size();
+
+	// Integers always come out of a transition as floats, so they're stored as such
+	Variant::Type type = p_value.get_type() == Variant::INT ? Variant::FLOAT : p_value.get_type();
+	Variant::Type end_type = p_end_value.get_type() == Variant::INT ? Variant::FLOAT : p_end_value.get_type();
+	if (idx == 0) {
+		r_track.components = value_components(type);
+		r_track.value_type = r_track.components > 0 ? type : Variant::NIL;
+	}
+	if (r_track.components > 0 && (type != r_track.value_type || end_type != r_track.value_type)) {
+		unpack_track(r_track);
+	}
+
+	float end = p_ease.time + p_ease.duration;
+	if (idx > 0 && end < r_track.ends[idx - 1]) r_track.sorted = false;
+	r_track.ends.append(end);
+	r_track.eases.append(p_ease);
+
+	if (r_track.components == 0) {
+		r_track.variant_values.append(p_value);
+		r_track.variant_end_values.append(p_end_value);
+		return;
+	}
+
+	int64_t c = r_track.components;
+	r_track.values.resize((idx + 1) * c);
+	pack_value(p_value, r_track.values.ptrw() + idx * c);
+
+	// Shake, pulse and elastic easings don't end on their value, the first of them makes the track store end values
+	if (!r_track.has_end_values && ease_keyframe(p_ease, p_ease.duration) != 1.0) {
+		r_track.end_values = r_track.values;
+		r_track.has_end_values = true;
+	}
+	if (r_track.has_end_values) {
+		r_track.end_values.resize((idx + 1) * c);
+		pack_value(p_end_value, r_track.end_values.ptrw() + idx * c);
+	}
+}
+
+void MotionRef::unpack_track(PropertyTrack &r_track) {
+	if (r_track.components == 0) return;
+
+	int64_t s = r_track.size();
+	int64_t c = r_track.components;
+	Variant::Type type = (Variant::Type)r_track.value_type;
+	const float *values = r_track.values.ptr();
+	const float *end_values = r_track.has_end_values ? r_track.end_values.ptr() : values;
+
+	r_track.variant_values.resize(s);
+	r_track.variant_end_values.resize(s);
+	for (int64_t i = 0; i < s; i++) {
+		r_track.variant_values.write[i] = unpack_value(type, values + i * c);
+		r_track.variant_end_values.write[i] = unpack_value(type, end_values + i * c);
+	}
+
+	r_track.values.clear();
+	r_track.end_values.clear();
+	r_track.value_type = Variant::NIL;
+	r_track.components = 0;
+	r_track.has_end_values = false;
+}
+
+void MotionRef::animate() {
+	evaluate();
+	apply();
+}
+
+void MotionRef::evaluate() {
+	// Only reads keyframes and writes the results, safe to run outside the main thread
+	for (HashMap<String, PropertyTrack>::Iterator track = property_tracks.begin(); track; ++track) {
+		if (track->value.sleeping) continue;
+		if (track->value.size() == 0) continue;
+
+		evaluate_track(track->value, time, track->value.result);
+	}
+
+	for (HashMap<String, SpringTrack>::Iterator spring = springs.begin(); spring; ++spring) {
+		if (spring->value.sleeping) continue;
+		step_spring(spring->value, step);
+	}
+	step = 0.0;
+}
+
+void MotionRef::apply() {
+	bool awake = false;
+
+	for (HashMap<String, PropertyTrack>::Iterator track = property_tracks.begin(); track; ++track) {
+		if (track->value.sleeping) continue;
+		if (track->value.size() == 0) continue;
+
+		apply_track(node, track->key, track->value.target, track->value.parameter, track->value.result);
+
+		// Past the last keyframe the value can't change anymore, the final value was just applied
+		if (time >= track->value.end_time) {
+			track->value.sleeping = true;
 		} else {
-			node->set(StringName(track->key), val);
+			awake = true;
+		}
+	}
+
+	for (HashMap<String, SpringTrack>::Iterator spring = springs.begin(); spring; ++spring) {
+		if (spring->value.sleeping) continue;
+
+		apply_track(node, spring->key, spring->value.target, spring->value.parameter, spring->value.result);
+
+		// Settled springs were snapped to their goal, they wake up again when retargeted
+		if (spring->value.settled) {
+			spring->value.sleeping = true;
+		} else {
+			awake = true;
+		}
+	}
+
+	if (callback_cursor_dirty) {
+		callback_cursor = seek_callbacks(prev_time);
+		callback_cursor_dirty = false;
+	}
+
+	if (loop_enabled && key_duration > 0.0 && time >= key_duration) {
+		// Fire the rest of each cycle crossed this frame, including callbacks placed at the very end
+		while (time >= key_duration) {
+			if (!fire_callbacks(callback_cursor, key_duration, true)) return;
+			time -= key_duration;
+			callback_cursor = 0;
+		}
+		if (!fire_callbacks(callback_cursor, time, false)) return;
+		wake();
+	} else {
+		if (!fire_callbacks(callback_cursor, time, false)) return;
+	}
+
+	if (!loop_enabled && !awake && time > key_duration) {
+		// Every track and callback is done, stop animating until woken by 'reset', 'delay' or a rebuild
+		sleeping = true;
+	}
+	prev_time = time;
+}
+
+bool MotionRef::advance_shared(int64_t p_subscriber, float p_delta) {
+	// Each subscriber is stepped by the UI it belongs to, against that UI's own clock
+	Subscriber &sub = subscribers.write[p_subscriber];
+	sub.time += p_delta;
+	sub.dirty = true;
+
+	bool first = !shared_dirty;
+	shared_dirty = true;
+	return first;
+}
+
+void MotionRef::animate_shared() {
+	// Evaluates every subscriber advanced since the last call as one batch
+	if (!shared_dirty) return;
+	shared_dirty = false;
+
+	int64_t count = subscribers.size();
+	Subscriber *subs = subscribers.ptrw();
+	LocalVector<Node *> nodes;
+	nodes.resize(count);
+
+	for (int64_t i = 0; i < count; i++) {
+		nodes[i] = nullptr;
+		if (!subs[i].dirty) continue;
+		nodes[i] = Object::cast_to<Node>(ObjectDB::get_instance(subs[i].node_id));
+		// Freed without unsubscribing, leave it asleep until it's removed
+		if (!nodes[i]) {
+			subs[i].dirty = false;
+			subs[i].sleeping = true;
 		}
 	}
 
-	{
-		uint64_t s = callback_track.size();
-		if (s != 0) {
-			uint64_t idx = 0;
-			for (uint64_t i = 0; i < s; i++) {
-				const CallbackKeyframe &key = callback_track[i];
+	// Tracks on the outside so each keyframe buffer is walked once for the whole batch
+	for (HashMap<String, PropertyTrack>::Iterator track = property_tracks.begin(); track; ++track) {
+		if (track->value.size() == 0) continue;
+
+		for (int64_t i = 0; i < count; i++) {
+			Subscriber &sub = subs[i];
+			if (!sub.dirty) continue;
 
-				float t = key.time;
+			Variant val;
+			evaluate_track(track->value, sub.time, val);
 
-				if (prev_time <= t && time > t) {
-					key.target.call();
-					break;
+			if (sub.value_scale != 1.0 || sub.value_offset.get_type() != Variant::NIL) {
+				bool valid;
+				Variant::evaluate(Variant::OP_MULTIPLY, val, sub.value_scale, val, valid);
+				if (valid && sub.value_offset.get_type() != Variant::NIL) {
+					Variant::evaluate(Variant::OP_ADD, val, sub.value_offset, val, valid);
 				}
+				ERR_CONTINUE_MSG(!valid, "Couldn't apply subscriber value scale or offset");
 			}
+
+			apply_track(nodes[i], track->key, track->value.target, track->value.parameter, val);
 		}
 	}
 
-	if (loop_enabled && time >= key_duration) time -= key_duration;
-	prev_time = time;
+	bool seek = callback_cursor_dirty;
+	callback_cursor_dirty = false;
+
+	for (int64_t i = 0; i < count; i++) {
+		Subscriber &sub = subs[i];
+		if (seek && !sub.sleeping) sub.callback_cursor = seek_callbacks(sub.prev_time);
+		if (!sub.dirty) continue;
+		sub.dirty = false;
+
+		if (loop_enabled && key_duration > 0.0) {
+			while (sub.time >= key_duration) {
+				if (!fire_callbacks(sub.callback_cursor, key_duration, true)) return;
+				sub.time -= key_duration;
+				sub.callback_cursor = 0;
+			}
+		}
+		if (!fire_callbacks(sub.callback_cursor, sub.time, false)) return;
+
+		sub.prev_time = sub.time;
+		if (!loop_enabled && sub.time > key_duration) {
+			sub.sleeping = true;
+		}
+	}
+
+	bool awake = false;
+	for (int64_t i = 0; i < count; i++) {
+		awake = awake || !subs[i].sleeping;
+	}
+	sleeping = !awake;
+}
+
+int64_t MotionRef::find_subscriber(Node *p_node) const {
+	HashMap<uint64_t, int64_t>::ConstIterator idx = subscriber_index.find(p_node->get_instance_id());
+	return idx ? idx->value : -1;
+}
+
+void MotionRef::subscribe(Node *p_node, float p_stagger, float p_value_scale, const Variant &p_value_offset) {
+	int64_t idx = find_subscriber(p_node);
+	if (idx == -1) {
+		Subscriber sub = Subscriber(p_node, p_stagger, p_value_scale, p_value_offset);
+		sub.callback_cursor = seek_callbacks(sub.prev_time);
+		subscriber_index.insert(p_node->get_instance_id(), subscribers.size());
+		subscribers.append(sub);
+		sleeping = false;
+	} else {
+		// Already animating, keep its clock and only update how values are mapped
+		Subscriber &sub = subscribers.write[idx];
+		sub.value_scale = p_value_scale;
+		sub.value_offset = p_value_offset;
+	}
+}
+
+void MotionRef::unsubscribe(Node *p_node) {
+	int64_t idx = find_subscriber(p_node);
+	if (idx == -1) return;
+
+	// Order doesn't matter, swap with the last one
+	int64_t last = subscribers.size() - 1;
+	subscriber_index.erase(p_node->get_instance_id());
+	if (idx != last) {
+		subscribers.write[idx] = subscribers[last];
+		subscriber_index[subscribers[idx].node_id] = idx;
+	}
+	subscribers.resize(last);
 }
 
 float MotionRef::eval_time(uint8_t p_ease_type, float p_time, float p_strength) {
@@ -106,23 +546,49 @@ float MotionRef::eval_time(uint8_t p_ease_type, float p_time, float p_strength)
 			return p_time < 0.2 ? eval_time(3, p_time * 5.0, p_strength) : eval_time(4, 1.0 - (p_time - 0.2) * 1.25, p_strength);
 		case 11: // Shake
 			return sin(p_time * Math_TAU * p_strength) * (1.0 - p_time);
+		case 12: // Cubic bezier
+		case 13: // Curve
+			// Custom easing only exists as a baked table
+			return p_time;
 		default: return 0.0;
 	}
 }
 
-void MotionRef::transition_value(const Variant &p_start, const Variant &p_end, Variant &p_out, uint8_t p_ease_type, float p_ease_strength, float p_time, float p_duration) {
-	p_time = p_duration == 0.0 ? (p_time < p_duration ? 0.0 : 1.0) : (p_time / p_duration);
-	float t = eval_time(p_ease_type, p_time, p_ease_strength);
+void MotionRef::set_ease_baking(int p_resolution, float p_error_bound, bool p_cubic) {
+	ERR_FAIL_COND_MSG(p_resolution < 0, "Resolution must be greater or equal 0");
+	EaseTable::set_baking(p_resolution, p_error_bound, p_cubic);
+}
+
+Ref<MotionRef> MotionRef::create_shared(const Callable &p_motion_callable) {
+	Ref<MotionRef> motion;
+	motion.instantiate();
+	motion->shared = true;
+	motion->clear();
+	p_motion_callable.call(motion);
+	return motion;
+}
+
+float MotionRef::ease_keyframe(const KeyframeEase &p_ease, float p_time) {
+	p_time = p_ease.duration == 0.0 ? (p_time < p_ease.duration ? 0.0 : 1.0) : (p_time / p_ease.duration);
+	return p_ease.table ? p_ease.table->sample(p_time) : eval_time(p_ease.type, p_time, p_ease.strength);
+}
+
+void MotionRef::interpolate_value(const Variant &p_start, const Variant &p_end, float p_t, Variant &r_out) {
 	Variant delta, res;
 	bool valid;
 	Variant::evaluate(Variant::OP_SUBTRACT, p_end, p_start, delta, valid);
 	ERR_FAIL_COND_MSG(!valid, "Couldn't evaluate transition between values");
-	Variant::evaluate(Variant::OP_MULTIPLY, delta, t, res, valid);
+	Variant::evaluate(Variant::OP_MULTIPLY, delta, p_t, res, valid);
 	ERR_FAIL_COND_MSG(!valid, "Couldn't evaluate transition between values");
-	Variant::evaluate(Variant::OP_ADD, p_start, res, p_out, valid);
+	Variant::evaluate(Variant::OP_ADD, p_start, res, r_out, valid);
 	ERR_FAIL_COND_MSG(!valid, "Couldn't evaluate transition between values");
 }
 
+void MotionRef::transition_value(const Variant &p_start, const Variant &p_end, Variant &p_out, uint8_t p_ease_type, float p_ease_strength, float p_time, float p_duration, const EaseTable *p_ease_table) {
+	float t = ease_keyframe(KeyframeEase(p_ease_table, 0.0, p_duration, p_ease_strength, p_ease_type), p_time);
+	interpolate_value(p_start, p_end, t, p_out);
+}
+
 void MotionRef::update_substate(bool p_key_parallel, float p_key_time, float p_key_duration) {
 	if (!p_key_parallel) {
 		key_time = p_key_time + key_duration;
@@ -137,6 +603,16 @@ void MotionRef::update_substate(bool p_key_parallel, float p_key_time, float p_k
 void MotionRef::reset() {
 	time = 0.0;
 	prev_time = 0.0;
+	for (int64_t i = 0; i < subscribers.size(); i++) {
+		Subscriber &sub = subscribers.write[i];
+		sub.time = 0.0;
+		sub.prev_time = 0.0;
+		sub.clock_resync = true;
+		sub.sleeping = false;
+	}
+	callback_cursor_dirty = true;
+	clock_resync = true;
+	wake();
 }
 
 Ref<MotionRef> MotionRef::loop(bool p_enabled) {
@@ -147,6 +623,16 @@ Ref<MotionRef> MotionRef::loop(bool p_enabled) {
 Ref<MotionRef> MotionRef::delay(float p_duration) {
 	time -= p_duration;
 	prev_time -= p_duration;
+	for (int64_t i = 0; i < subscribers.size(); i++) {
+		Subscriber &sub = subscribers.write[i];
+		sub.time -= p_duration;
+		sub.prev_time -= p_duration;
+		sub.clock_resync = true;
+		sub.sleeping = false;
+	}
+	callback_cursor_dirty = true;
+	clock_resync = true;
+	wake();
 	return this;
 }
 
@@ -223,12 +709,46 @@ Ref<MotionRef> MotionRef::prop(const String &p_name, bool p_indexed) {
 
 	// update_substate(key_parallel, key_time, key_duration);
 
-	this->property_track = get_property_track(p_name, p_indexed);
+	this->property_track = get_property_track(p_name, p_indexed ? TARGET_INDEXED : TARGET_PROPERTY);
+
+	return this;
+}
+
+Ref<MotionRef> MotionRef::visual(const String &p_channel) {
+	ERR_FAIL_COND_V_MSG(shared, this, "Shared motions can't animate visual channels");
+
+	uint8_t target;
+	if (p_channel == "position") target = TARGET_VISUAL_POSITION;
+	else if (p_channel == "rotation") target = TARGET_VISUAL_ROTATION;
+	else if (p_channel == "scale") target = TARGET_VISUAL_SCALE;
+	else if (p_channel == "modulate") target = TARGET_VISUAL_MODULATE;
+	else ERR_FAIL_V_MSG(this, vformat("Unknown visual channel '%s', expected 'position', 'rotation', 'scale' or 'modulate'", p_channel));
+
+	// Visual values persist across rebuilds like node properties do
+	visual_enabled = true;
+	this->property_track = get_property_track("__godui_visual:" + p_channel, target);
+
+	return this;
+}
+
+Ref<MotionRef> MotionRef::shader_param(const String &p_name) {
+	ERR_FAIL_COND_V_MSG(shared, this, "Shared motions can't animate shader parameters");
+	ERR_FAIL_COND_V_MSG(!resolve_shader_material(), this, "Node must be a CanvasItem with a ShaderMaterial");
+
+	this->property_track = get_property_track("__godui_shader:" + p_name, TARGET_SHADER_PARAMETER);
 
 	return this;
 }
 
 Ref<MotionRef> MotionRef::keyframe(Variant p_value, float p_duration, uint8_t p_ease_mode, float p_ease_strength) {
+	return keyframe_table(p_value, p_duration, p_ease_mode, p_ease_strength, EaseTable::get(p_ease_mode, p_ease_strength));
+}
+
+Ref<MotionRef> MotionRef::keyframe_table(Variant p_value, float p_duration, uint8_t p_ease_mode, float p_ease_strength, const EaseTable *p_ease_table) {
+	// Adopts the reference EaseTable handed out, released on every return path
+	KeyframeEase owner;
+	owner.table = p_ease_table;
+
 	ERR_FAIL_COND_V_MSG(p_duration < 0.0, this, "Duration must be greater or equal 0.0");
 	ERR_FAIL_COND_V_MSG(!property_track, this, "Must call 'prop' first");
 	PropertyTrack &track = property_track->value;
@@ -236,10 +756,17 @@ Ref<MotionRef> MotionRef::keyframe(Variant p_value, float p_duration, uint8_t p_
 	p_duration *= key_scale;
 
 	Variant end_val;
-	transition_value(track.current_value, p_value, end_val, p_ease_mode, p_ease_strength, 1.0, 1.0);
+	if (track.current_value.get_type() == Variant::NIL) {
+		end_val = p_value;
+	} else {
+		transition_value(track.current_value, p_value, end_val, p_ease_mode, p_ease_strength, 1.0, 1.0, p_ease_table);
+	}
 	track.current_value = end_val;
 
-	track.track.append(PropertyKeyframe(key_time, p_duration, p_value, end_val, p_ease_mode, p_ease_strength));
+	append_keyframe(track, KeyframeEase(p_ease_table, key_time, p_duration, p_ease_strength, p_ease_mode), p_value, end_val);
+	track.end_time = MAX(track.end_time, key_time + p_duration);
+	track.sleeping = false;
+	sleeping = false;
 
 	if (!key_parallel) {
 		key_time += p_duration;
@@ -251,9 +778,50 @@ Ref<MotionRef> MotionRef::keyframe(Variant p_value, float p_duration, uint8_t p_
 	return this;
 }
 
+Ref<MotionRef> MotionRef::spring(Variant p_target, float p_half_life) {
+	ERR_FAIL_COND_V_MSG(shared, this, "Shared motions can't animate springs");
+	ERR_FAIL_COND_V_MSG(p_half_life <= 0.0, this, "Half life must be greater than 0.0");
+	ERR_FAIL_COND_V_MSG(!property_track, this, "Must call 'prop' first");
+
+	Variant::Type type = p_target.get_type() == Variant::INT ? Variant::FLOAT : p_target.get_type();
+	uint8_t components = value_components(type);
+	ERR_FAIL_COND_V_MSG(components == 0, this, vformat("Can't spring values of type %s", Variant::get_type_name(type)));
+
+	HashMap<String, SpringTrack>::Iterator spring = springs.find(property_track->key);
+	if (!spring) {
+		const PropertyTrack &track = property_track->value;
+		Variant::Type current_type = track.current_value.get_type() == Variant::INT ? Variant::FLOAT : track.current_value.get_type();
+
+		spring = springs.insert(property_track->key, SpringTrack());
+		spring->value.parameter = track.parameter;
+		spring->value.value_type = type;
+		spring->value.components = components;
+		spring->value.target = track.target;
+		// Starts from the property's value, or already settled when it can't be read
+		pack_value(current_type == type ? track.current_value : p_target, spring->value.value);
+	} else {
+		ERR_FAIL_COND_V_MSG(spring->value.value_type != type, this, vformat("Spring target must be of type %s", Variant::get_type_name((Variant::Type)spring->value.value_type)));
+	}
+
+	// Retargeting only swaps the goal, the value and velocity carry on
+	pack_value(p_target, spring->value.goal);
+	spring->value.half_life = p_half_life;
+	spring->value.settled = false;
+	spring->value.sleeping = false;
+	spring->value.declared = true;
+	sleeping = false;
+
+	return this;
+}
+
 Ref<MotionRef> MotionRef::callback(const Callable &p_callback_callable) {
-	callback_track.append(CallbackKeyframe(key_time, p_callback_callable));
-	
+	// Keep callbacks sorted by time, equal times fire in the order they were added
+	int64_t idx = callback_track.size();
+	while (idx > 0 && callback_track[idx - 1].time > key_time) idx--;
+	callback_track.insert(idx, CallbackKeyframe(key_time, p_callback_callable));
+	callback_cursor_dirty = true;
+	sleeping = false;
+
 	return this;
 }
 
@@ -281,8 +849,55 @@ Ref<MotionRef> MotionRef::repeat(int p_times, const Callable &p_motion_callable)
 	return this;
 }
 
+Ref<MotionTimeline> MotionRef::compile() const {
+	Ref<MotionTimeline> timeline;
+	timeline.instantiate();
+	timeline->encode(this);
+	return timeline;
+}
+
+Ref<MotionRef> MotionRef::timeline(const Ref<MotionTimeline> &p_timeline, const Array &p_callbacks) {
+	ERR_FAIL_COND_V_MSG(p_timeline.is_null(), this, "Timeline is null");
+
+	// Keyframe buffers are copy-on-write, binding only copies the track headers
+	for (HashMap<String, PropertyTrack>::ConstIterator track = p_timeline->tracks.begin(); track; ++track) {
+		HashMap<String, PropertyTrack>::Iterator dst = property_tracks.find(track->key);
+		ERR_CONTINUE_MSG(dst && dst->value.size() > 0, vformat("Track '%s' already has keyframes", track->key));
+
+		uint8_t target = track->value.target;
+		if (target == TARGET_SHADER_PARAMETER) {
+			ERR_CONTINUE_MSG(shared || !resolve_shader_material(), vformat("Track '%s' needs a CanvasItem with a ShaderMaterial", track->key));
+		}
+
+		dst = property_tracks.insert(track->key, track->value);
+		if (target == TARGET_SHADER_PARAMETER) {
+			dst->value.parameter = StringName(track->key.substr(track->key.find(":") + 1));
+		} else if (target >= TARGET_VISUAL_POSITION) {
+			visual_enabled = true;
+		}
+	}
+
+	for (int64_t i = 0; i < p_timeline->callback_times.size(); i++) {
+		ERR_CONTINUE_MSG(i >= p_callbacks.size(), vformat("Missing callable for callback slot %d", i));
+		float t = p_timeline->callback_times[i];
+		int64_t idx = callback_track.size();
+		while (idx > 0 && callback_track[idx - 1].time > t) idx--;
+		callback_track.insert(idx, CallbackKeyframe(t, p_callbacks[i]));
+	}
+
+	loop_enabled = loop_enabled || p_timeline->loop_enabled;
+	key_time = MAX(key_time, p_timeline->key_time);
+	key_duration = MAX(key_duration, p_timeline->duration);
+	property_track = property_tracks.end();
+	callback_cursor_dirty = true;
+	sleeping = false;
+
+	return this;
+}
+
 Variant MotionRef::current() {
 	ERR_FAIL_COND_V_MSG(!property_track, Variant(), "Must call 'prop' first");
+	ERR_FAIL_COND_V_MSG(shared && property_track->value.current_value.get_type() == Variant::NIL, Variant(), "Shared motions have no current value, start the track with 'frame'");
 
 	return property_track->value.current_value;
 }
@@ -355,9 +970,22 @@ Ref<MotionRef> MotionRef::shake(Variant p_magnitude, float p_duration, float p_s
 	return this->keyframe(p_magnitude, p_duration, 11, p_strength);
 }
 
+Ref<MotionRef> MotionRef::cubic_bezier(Variant p_to_value, float p_duration, float p_x1, float p_y1, float p_x2, float p_y2) {
+	return this->keyframe_table(p_to_value, p_duration, 12, 0.0, EaseTable::get_bezier(p_x1, p_y1, p_x2, p_y2));
+}
+
+Ref<MotionRef> MotionRef::ease_curve(Variant p_to_value, float p_duration, const Ref<Curve> &p_curve) {
+	ERR_FAIL_COND_V_MSG(p_curve.is_null(), this, "Curve is null");
+	return this->keyframe_table(p_to_value, p_duration, 13, 0.0, EaseTable::get_curve(p_curve));
+}
+
 void MotionRef::_bind_methods() {
+	ClassDB::bind_static_method("MotionRef", D_METHOD("set_ease_baking", "resolution", "error_bound", "cubic"), &MotionRef::set_ease_baking, DEFVAL(0.001), DEFVAL(true));
+	ClassDB::bind_static_method("MotionRef", D_METHOD("create_shared", "motion_callable"), &MotionRef::create_shared);
+
 	ClassDB::bind_method(D_METHOD("get_time"), &MotionRef::get_time);
 	ClassDB::bind_method(D_METHOD("get_duration"), &MotionRef::get_duration);
+	ClassDB::bind_method(D_METHOD("is_sleeping"), &MotionRef::is_sleeping);
 
 	ClassDB::bind_method(D_METHOD("reset"), &MotionRef::reset);
 	ClassDB::bind_method(D_METHOD("loop", "enabled"), &MotionRef::loop, DEFVAL(true));
@@ -367,10 +995,15 @@ void MotionRef::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("chain", "motion_callable"), &MotionRef::chain);
 	ClassDB::bind_method(D_METHOD("scale", "scale", "motion_callable"), &MotionRef::scale);
 	ClassDB::bind_method(D_METHOD("prop", "name", "indexed"), &MotionRef::prop, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("visual", "channel"), &MotionRef::visual);
+	ClassDB::bind_method(D_METHOD("shader_param", "name"), &MotionRef::shader_param);
 	// ClassDB::bind_method(D_METHOD("keyframe", "value", "duration", "ease_mode", "ease_strength"), &MotionRef::keyframe);
+	ClassDB::bind_method(D_METHOD("spring", "target", "half_life"), &MotionRef::spring, DEFVAL(0.15));
 	ClassDB::bind_method(D_METHOD("callback", "callback_callable"), &MotionRef::callback);
 	ClassDB::bind_method(D_METHOD("wait", "duration"), &MotionRef::wait);
 	ClassDB::bind_method(D_METHOD("repeat", "times", "motion_callable"), &MotionRef::repeat);
+	ClassDB::bind_method(D_METHOD("compile"), &MotionRef::compile);
+	ClassDB::bind_method(D_METHOD("timeline", "timeline", "callbacks"), &MotionRef::timeline, DEFVAL(Array()));
 
 	ClassDB::bind_method(D_METHOD("current"), &MotionRef::current);
 	ClassDB::bind_method(D_METHOD("relative", "delta"), &MotionRef::relative);
@@ -389,18 +1022,38 @@ void MotionRef::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("elastic_out_in", "to_value", "duration", "strength"), &MotionRef::elastic_out_in, DEFVAL(3.0));
 	ClassDB::bind_method(D_METHOD("pulse", "to_value", "duration", "strength"), &MotionRef::pulse, DEFVAL(3.0));
 	ClassDB::bind_method(D_METHOD("shake", "magnitude", "duration", "strength"), &MotionRef::shake, DEFVAL(3.0));
+	ClassDB::bind_method(D_METHOD("cubic_bezier", "to_value", "duration", "x1", "y1", "x2", "y2"), &MotionRef::cubic_bezier);
+	ClassDB::bind_method(D_METHOD("ease_curve", "to_value", "duration", "curve"), &MotionRef::ease_curve);
 }
 
 MotionRef::MotionRef() {
 	node = nullptr;
+	shared = false;
+	shared_dirty = false;
+	subscribers = Vector<Subscriber>();
+	subscriber_index = HashMap<uint64_t, int64_t>();
 	prev_time = 0.0;
 	time = 0.0;
+	step = 0.0;
 	loop_enabled = false;
+	sleeping = false;
+	clock = 0.0;
+	clock_resync = true;
+	visual_position = Vector2();
+	visual_rotation = 0.0;
+	visual_scale = Vector2(1.0, 1.0);
+	visual_modulate = Color(1.0, 1.0, 1.0, 1.0);
+	visual_enabled = false;
+	shader_material = Ref<ShaderMaterial>();
+	shader_material_rid = RID();
 	key_time = 0.0;
 	key_duration = 0.0;
 	key_parallel = 0.0;
 	key_scale = 0.0;
 	property_tracks = HashMap<String, PropertyTrack>();
 	property_track = property_tracks.end();
+	springs = HashMap<String, SpringTrack>();
 	callback_track = Vector<CallbackKeyframe>();
+	callback_cursor = 0;
+	callback_cursor_dirty = true;
 }
\ No newline at end of file
@@ -1,47 +1,139 @@
 #ifndef GODUI_MOTION_REF_H
 #define GODUI_MOTION_REF_H
 
+#include "ease_table.h"
 #include <godot_cpp/variant/variant.hpp>
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/core/object_id.hpp>
+#include <godot_cpp/classes/curve.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
 namespace godot {
 
 class UI;
+class MotionTimeline;
 
 class MotionRef : public RefCounted {
 	GDCLASS(MotionRef, RefCounted);
 
 	friend class UI;
+	friend class MotionTimeline;
 
-	struct PropertyKeyframe {
+	enum TrackTarget : uint8_t {
+		TARGET_PROPERTY = 0,
+		TARGET_INDEXED = 1,
+		TARGET_VISUAL_POSITION = 2,
+		TARGET_VISUAL_ROTATION = 3,
+		TARGET_VISUAL_SCALE = 4,
+		TARGET_VISUAL_MODULATE = 5,
+		TARGET_SHADER_PARAMETER = 6,
+	};
+
+	struct KeyframeEase {
+		// Referenced, the table outlives its eviction from the cache while a keyframe still samples it
+		const EaseTable *table;
 		float time;
 		float duration;
-		Variant value;
-		Variant end_value;
-		uint8_t ease_type;
-		float ease_strength;
-
-		inline PropertyKeyframe() {}
-
-		inline PropertyKeyframe(
-			float p_time, float p_duration, Variant p_value, Variant p_end_value,
-			uint8_t p_ease_type, float p_ease_strength
-		): time(p_time), duration(p_duration), value(p_value), end_value(p_end_value),
-		ease_type(p_ease_type), ease_strength(p_ease_strength) {}
+		float strength;
+		uint8_t type;
+
+		inline void set_table(const EaseTable *p_table) {
+			if (p_table) p_table->reference();
+			EaseTable::unreference(table);
+			table = p_table;
+		}
+
+		inline KeyframeEase(): table(nullptr), time(0.0), duration(0.0), strength(0.0), type(0) {}
+
+		inline KeyframeEase(const EaseTable *p_table, float p_time, float p_duration, float p_strength, uint8_t p_type):
+		table(nullptr), time(p_time), duration(p_duration), strength(p_strength), type(p_type) { set_table(p_table); }
+
+		inline KeyframeEase(const KeyframeEase &p_other):
+		table(nullptr), time(p_other.time), duration(p_other.duration), strength(p_other.strength), type(p_other.type) { set_table(p_other.table); }
+
+		inline KeyframeEase &operator=(const KeyframeEase &p_other) {
+			set_table(p_other.table);
+			time = p_other.time;
+			duration = p_other.duration;
+			strength = p_other.strength;
+			type = p_other.type;
+			return *this;
+		}
+
+		inline ~KeyframeEase() { EaseTable::unreference(table); }
 	};
 
 	struct PropertyTrack {
-		Vector<PropertyKeyframe> track;
+		// Keyframe end times, searched on every evaluation so they're kept apart from everything else
+		Vector<float> ends;
+		Vector<KeyframeEase> eases;
+		// Unboxed values, 'components' floats per keyframe, end values are only stored when an easing doesn't land on its value
+		Vector<float> values;
+		Vector<float> end_values;
+		// Fallback for value types that can't be unboxed
+		Vector<Variant> variant_values;
+		Vector<Variant> variant_end_values;
 		Variant current_value;
-		bool indexed;
+		Variant result;
+		StringName parameter;
+		float end_time;
+		uint8_t value_type;
+		uint8_t components;
+		uint8_t target;
+		bool has_end_values;
+		bool sorted;
+		bool sleeping;
+
+		inline int64_t size() const { return ends.size(); }
 
 		inline PropertyTrack() {
-			track = Vector<PropertyKeyframe>();
+			ends = Vector<float>();
+			eases = Vector<KeyframeEase>();
+			values = Vector<float>();
+			end_values = Vector<float>();
+			variant_values = Vector<Variant>();
+			variant_end_values = Vector<Variant>();
 			current_value = Variant();
-			indexed = false;
+			parameter = StringName();
+			end_time = 0.0;
+			value_type = Variant::NIL;
+			components = 0;
+			target = TARGET_PROPERTY;
+			has_end_values = false;
+			sorted = true;
+			sleeping = false;
+		}
+	};
+
+	// Stateful, unlike keyframe tracks they survive rebuilds so retargeting keeps the velocity
+	struct SpringTrack {
+		float value[4];
+		float velocity[4];
+		float goal[4];
+		float half_life;
+		StringName parameter;
+		Variant result;
+		uint8_t value_type;
+		uint8_t components;
+		uint8_t target;
+		bool settled;
+		bool sleeping;
+		bool declared;
+
+		inline SpringTrack() {
+			for (int i = 0; i < 4; i++) value[i] = velocity[i] = goal[i] = 0.0;
+			half_life = 0.0;
+			parameter = StringName();
+			result = Variant();
+			value_type = Variant::NIL;
+			components = 0;
+			target = TARGET_PROPERTY;
+			settled = false;
+			sleeping = false;
+			declared = false;
 		}
 	};
 
@@ -53,11 +145,48 @@ class MotionRef : public RefCounted {
 		inline CallbackKeyframe(float p_time, const Callable &p_target): time(p_time), target(p_target) {}
 	};
 
+	struct Subscriber {
+		ObjectID node_id;
+		float prev_time;
+		float time;
+		float value_scale;
+		Variant value_offset;
+		uint64_t callback_cursor;
+		// Stamp of the subscribing UI's motion clock, like 'MotionRef::clock'
+		double clock;
+		bool clock_resync;
+		bool sleeping;
+		bool dirty;
+
+		inline Subscriber() {}
+		inline Subscriber(Node *p_node, float p_stagger, float p_value_scale, const Variant &p_value_offset):
+		node_id(p_node->get_instance_id()), prev_time(-p_stagger), time(-p_stagger), value_scale(p_value_scale),
+		value_offset(p_value_offset), callback_cursor(0), clock(0.0), clock_resync(true), sleeping(false), dirty(false) {}
+	};
+
 	Node *node;
+	bool shared;
+	bool shared_dirty;
+	Vector<Subscriber> subscribers;
+	HashMap<uint64_t, int64_t> subscriber_index;
 
 	float prev_time;
 	float time;
+	float step;
 	bool loop_enabled;
+	bool sleeping;
+
+	double clock;
+	bool clock_resync;
+
+	Vector2 visual_position;
+	float visual_rotation;
+	Vector2 visual_scale;
+	Color visual_modulate;
+	bool visual_enabled;
+
+	Ref<ShaderMaterial> shader_material;
+	RID shader_material_rid;
 	
 	float key_time;
 	float key_duration;
@@ -66,24 +195,58 @@ class MotionRef : public RefCounted {
 
 	HashMap<String, PropertyTrack> property_tracks;
 	HashMap<String, PropertyTrack>::Iterator property_track;
+	HashMap<String, SpringTrack> springs;
 	Vector<CallbackKeyframe> callback_track;
+	uint64_t callback_cursor;
+	bool callback_cursor_dirty;
 
 protected:
-	HashMap<String, PropertyTrack>::Iterator get_property_track(const String &p_name, bool p_indexed);
+	HashMap<String, PropertyTrack>::Iterator get_property_track(const String &p_name, uint8_t p_target);
+	Variant get_visual(uint8_t p_target) const;
+	Transform2D get_visual_transform(const Vector2 &p_pivot) const;
+	bool resolve_shader_material();
+	Variant get_shader_parameter(const StringName &p_parameter) const;
 	void clear();
+	void prune_springs();
+	void wake();
+	uint64_t seek_callbacks(float p_time) const;
+	bool fire_callbacks(uint64_t &r_cursor, float p_to, bool p_inclusive);
+	void evaluate_track(const PropertyTrack &p_track, float p_time, Variant &r_value);
+	void apply_track(Node *p_node, const String &p_name, uint8_t p_target, const StringName &p_parameter, const Variant &p_value);
+	static void step_spring(SpringTrack &r_spring, float p_delta);
+	static uint8_t value_components(Variant::Type p_type);
+	static void pack_value(const Variant &p_value, float *r_out);
+	static Variant unpack_value(Variant::Type p_type, const float *p_in);
+	static void append_keyframe(PropertyTrack &r_track, const KeyframeEase &p_ease, const Variant &p_value, const Variant &p_end_value);
+	static void unpack_track(PropertyTrack &r_track);
 	void animate();
+	void evaluate();
+	void apply();
+	bool advance_shared(int64_t p_subscriber, float p_delta);
+	void animate_shared();
+
+	int64_t find_subscriber(Node *p_node) const;
+	void subscribe(Node *p_node, float p_stagger, float p_value_scale, const Variant &p_value_offset);
+	void unsubscribe(Node *p_node);
 	// void update_keyframes();
 
-	float eval_time(uint8_t p_ease_type, float p_time, float p_ease_strength);
-	void transition_value(const Variant &p_start, const Variant &p_end, Variant &p_out, uint8_t p_ease_type, float p_ease_strength, float p_time, float p_duration);
+	static float ease_keyframe(const KeyframeEase &p_ease, float p_time);
+	static void interpolate_value(const Variant &p_start, const Variant &p_end, float p_t, Variant &r_out);
+	void transition_value(const Variant &p_start, const Variant &p_end, Variant &p_out, uint8_t p_ease_type, float p_ease_strength, float p_time, float p_duration, const EaseTable *p_ease_table = nullptr);
 	void update_substate(bool p_key_parallel, float p_key_time, float p_key_duration);
+	Ref<MotionRef> keyframe_table(Variant p_value, float p_duration, uint8_t p_ease_mode, float p_ease_strength, const EaseTable *p_ease_table);
 
 	static void _bind_methods();
 public:
+	static float eval_time(uint8_t p_ease_type, float p_time, float p_ease_strength);
+	static void set_ease_baking(int p_resolution, float p_error_bound = 0.001, bool p_cubic = true);
+	static Ref<MotionRef> create_shared(const Callable &p_motion_callable);
+
 	void reset();
 
 	inline float get_time() const { return key_time; }
 	inline float get_duration() const { return key_duration; }
+	inline bool is_sleeping() const { return sleeping; }
 
 	Ref<MotionRef> loop(bool p_enabled = true);
 	Ref<MotionRef> delay(float p_duration);
@@ -92,11 +255,17 @@ public:
 	Ref<MotionRef> chain(const Callable &p_motion_callable);
 	Ref<MotionRef> scale(float p_scale, const Callable &p_motion_callable);
 	Ref<MotionRef> prop(const String &p_name, bool p_indexed = false);
+	Ref<MotionRef> visual(const String &p_channel);
+	Ref<MotionRef> shader_param(const String &p_name);
 	Ref<MotionRef> keyframe(Variant p_value, float p_duration, uint8_t p_ease_mode, float p_ease_strength);
+	Ref<MotionRef> spring(Variant p_target, float p_half_life = 0.15);
 	Ref<MotionRef> callback(const Callable &p_callback_callable);
 	Ref<MotionRef> wait(float p_duration);
 	Ref<MotionRef> repeat(int p_times, const Callable &p_motion_callable);
 
+	Ref<MotionTimeline> compile() const;
+	Ref<MotionRef> timeline(const Ref<MotionTimeline> &p_timeline, const Array &p_callbacks = Array());
+
 	Variant current();
 	Variant relative(Variant p_delta);
 
@@ -118,6 +287,9 @@ public:
 	Ref<MotionRef> pulse(Variant p_to_value, float p_duration, float p_strength);
 	Ref<MotionRef> shake(Variant p_magnitude, float p_duration, float p_strength);
 
+	Ref<MotionRef> cubic_bezier(Variant p_to_value, float p_duration, float p_x1, float p_y1, float p_x2, float p_y2);
+	Ref<MotionRef> ease_curve(Variant p_to_value, float p_duration, const Ref<Curve> &p_curve);
+
 	MotionRef();
 };
 
@@ -0,0 +1,223 @@
+#include "motion_timeline.h"
+#include "ease_table.h"
+#include <godot_cpp/classes/stream_peer_buffer.hpp>
+
+using namespace godot;
+
+// Layout (little endian):
+//   u32 magic, u16 version, u8 flags (bit 0: loop), f32 duration, f32 key time
+//   u32 track count, per track:
+//     utf8 name, u8 target, var current value
+//     u8 value type (nil when boxed), u8 components, u8 flags (bit 0: end values, bit 1: sorted)
+//     u32 keyframe count, per keyframe:
+//       f32 time, f32 duration, u8 ease type, f32 ease strength
+//       u8 baked, if set: u8 cubic, u32 sample count, f32 samples...
+//     unboxed: f32 values[count * components], f32 end values[count * components] if flagged
+//     boxed: var value, var end value per keyframe
+//   u32 callback count, per callback: f32 time (callables are bound by slot index)
+// Version 1 stored a var value and end value inside every keyframe, after the ease strength
+
+void MotionTimeline::encode(const MotionRef *p_motion) {
+	Ref<StreamPeerBuffer> buf;
+	buf.instantiate();
+
+	buf->put_u32(MAGIC);
+	buf->put_u16(VERSION);
+	buf->put_u8(p_motion->loop_enabled ? 1 : 0);
+	buf->put_float(p_motion->key_duration);
+	buf->put_float(p_motion->key_time);
+
+	buf->put_u32(p_motion->property_tracks.size());
+	for (HashMap<String, MotionRef::PropertyTrack>::ConstIterator track = p_motion->property_tracks.begin(); track; ++track) {
+		const MotionRef::PropertyTrack &pt = track->value;
+		buf->put_utf8_string(track->key);
+		buf->put_u8(pt.target);
+		buf->put_var(pt.current_value);
+		buf->put_u8(pt.value_type);
+		buf->put_u8(pt.components);
+		buf->put_u8((pt.has_end_values ? 1 : 0) | (pt.sorted ? 2 : 0));
+
+		buf->put_u32(pt.size());
+		for (int64_t i = 0; i < pt.size(); i++) {
+			const MotionRef::KeyframeEase &ease = pt.eases[i];
+			buf->put_float(ease.time);
+			buf->put_float(ease.duration);
+			buf->put_u8(ease.type);
+			buf->put_float(ease.strength);
+
+			// Builtin easings are rebaked on load with the current settings, custom curves only exist as samples
+			bool baked = ease.table && ease.type >= 12;
+			buf->put_u8(baked ? 1 : 0);
+			if (baked) {
+				const Vector<float> &samples = ease.table->get_samples();
+				buf->put_u8(ease.table->is_cubic() ? 1 : 0);
+				buf->put_u32(samples.size());
+				for (int64_t j = 0; j < samples.size(); j++) buf->put_float(samples[j]);
+			}
+		}
+
+		if (pt.components > 0) {
+			for (int64_t i = 0; i < pt.values.size(); i++) buf->put_float(pt.values[i]);
+			for (int64_t i = 0; i < pt.end_values.size(); i++) buf->put_float(pt.end_values[i]);
+		} else {
+			for (int64_t i = 0; i < pt.size(); i++) {
+				buf->put_var(pt.variant_values[i]);
+				buf->put_var(pt.variant_end_values[i]);
+			}
+		}
+	}
+
+	buf->put_u32(p_motion->callback_track.size());
+	for (int64_t i = 0; i < p_motion->callback_track.size(); i++) {
+		buf->put_float(p_motion->callback_track[i].time);
+	}
+
+	data = buf->get_data_array();
+	tracks.clear();
+	callback_times.clear();
+	decode();
+}
+
+bool MotionTimeline::decode() {
+	tracks.clear();
+	callback_times.clear();
+	duration = 0.0;
+	key_time = 0.0;
+	loop_enabled = false;
+
+	if (data.is_empty()) return true;
+
+	Ref<StreamPeerBuffer> buf;
+	buf.instantiate();
+	buf->set_data_array(data);
+
+	#define ENSURE(p_bytes) ERR_FAIL_COND_V_MSG(buf->get_available_bytes() < (p_bytes), false, "Motion timeline data is truncated")
+
+	ENSURE(19);
+	ERR_FAIL_COND_V_MSG(buf->get_u32() != MAGIC, false, "Not a motion timeline");
+	uint16_t version = buf->get_u16();
+	ERR_FAIL_COND_V_MSG(version > VERSION, false, vformat("Unsupported motion timeline version %d", version));
+
+	loop_enabled = (buf->get_u8() & 1) != 0;
+	duration = buf->get_float();
+	key_time = buf->get_float();
+
+	ENSURE(4);
+	uint32_t track_count = buf->get_u32();
+	for (uint32_t t = 0; t < track_count; t++) {
+		String name = buf->get_utf8_string();
+		ENSURE(1);
+		MotionRef::PropertyTrack track;
+		track.target = buf->get_u8();
+		track.current_value = buf->get_var();
+
+		uint8_t flags = 0;
+		if (version >= 2) {
+			ENSURE(3);
+			track.value_type = buf->get_u8();
+			track.components = buf->get_u8();
+			flags = buf->get_u8();
+			ERR_FAIL_COND_V_MSG(track.value_type >= Variant::VARIANT_MAX || track.components != MotionRef::value_components((Variant::Type)track.value_type), false, "Invalid motion timeline track value type");
+			track.has_end_values = track.components > 0 && (flags & 1) != 0;
+			track.sorted = (flags & 2) != 0;
+		}
+
+		ENSURE(4);
+		uint32_t key_count = buf->get_u32();
+		for (uint32_t i = 0; i < key_count; i++) {
+			ENSURE(13);
+			MotionRef::KeyframeEase ease;
+			ease.time = buf->get_float();
+			ease.duration = buf->get_float();
+			ease.type = buf->get_u8();
+			ease.strength = buf->get_float();
+
+			Variant value, end_value;
+			if (version < 2) {
+				value = buf->get_var();
+				end_value = buf->get_var();
+			}
+
+			// The table's reference is adopted by the keyframe as is
+			ENSURE(1);
+			if (buf->get_u8()) {
+				ENSURE(5);
+				bool cubic = buf->get_u8() != 0;
+				uint32_t count = buf->get_u32();
+				ENSURE((int64_t)count * 4);
+				Vector<float> samples;
+				samples.resize(count);
+				for (uint32_t j = 0; j < count; j++) samples.write[j] = buf->get_float();
+				ease.table = EaseTable::get_baked(ease.type, samples, cubic);
+			} else {
+				ease.table = EaseTable::get(ease.type, ease.strength);
+			}
+
+			if (version < 2) {
+				// Boxed values get unboxed the same way keyframes built at runtime are
+				MotionRef::append_keyframe(track, ease, value, end_value);
+			} else {
+				track.ends.append(ease.time + ease.duration);
+				track.eases.append(ease);
+			}
+			track.end_time = MAX(track.end_time, ease.time + ease.duration);
+		}
+
+		if (version >= 2 && track.components > 0) {
+			int64_t count = (int64_t)key_count * track.components;
+			ENSURE(count * 4 * (track.has_end_values ? 2 : 1));
+			track.values.resize(count);
+			for (int64_t i = 0; i < count; i++) track.values.write[i] = buf->get_float();
+			if (track.has_end_values) {
+				track.end_values.resize(count);
+				for (int64_t i = 0; i < count; i++) track.end_values.write[i] = buf->get_float();
+			}
+		} else if (version >= 2) {
+			track.variant_values.resize(key_count);
+			track.variant_end_values.resize(key_count);
+			for (uint32_t i = 0; i < key_count; i++) {
+				track.variant_values.write[i] = buf->get_var();
+				track.variant_end_values.write[i] = buf->get_var();
+			}
+		}
+
+		tracks.insert(name, track);
+	}
+
+	ENSURE(4);
+	uint32_t callback_count = buf->get_u32();
+	ENSURE((int64_t)callback_count * 4);
+	callback_times.resize(callback_count);
+	for (uint32_t i = 0; i < callback_count; i++) {
+		callback_times.write[i] = buf->get_float();
+	}
+
+	#undef ENSURE
+
+	return true;
+}
+
+void MotionTimeline::set_data(const PackedByteArray &p_data) {
+	data = p_data;
+	if (!decode()) {
+		tracks.clear();
+		callback_times.clear();
+	}
+}
+
+void MotionTimeline::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_data", "data"), &MotionTimeline::set_data);
+	ClassDB::bind_method(D_METHOD("get_data"), &MotionTimeline::get_data);
+	ClassDB::bind_method(D_METHOD("get_duration"), &MotionTimeline::get_duration);
+	ClassDB::bind_method(D_METHOD("get_callback_count"), &MotionTimeline::get_callback_count);
+	ClassDB::add_property("MotionTimeline", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE), "set_data", "get_data");
+}
+
+MotionTimeline::MotionTimeline() {
+	data = PackedByteArray();
+	tracks = HashMap<String, MotionRef::PropertyTrack>();
+	callback_times = Vector<float>();
+	duration = 0.0;
+	key_time = 0.0;
+	loop_enabled = false;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef GODUI_MOTION_TIMELINE_H
+#define GODUI_MOTION_TIMELINE_H
+
+#include "motion_ref.h"
+
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/vector.hpp>
+
+namespace godot {
+
+class MotionTimeline : public Resource {
+	GDCLASS(MotionTimeline, Resource);
+
+	friend class MotionRef;
+
+	PackedByteArray data;
+
+	HashMap<String, MotionRef::PropertyTrack> tracks;
+	Vector<float> callback_times;
+	float duration;
+	float key_time;
+	bool loop_enabled;
+
+	void encode(const MotionRef *p_motion);
+	bool decode();
+
+protected:
+	static void _bind_methods();
+
+public:
+	static const uint32_t MAGIC = 0x544d4447; // "GDMT"
+	static const uint16_t VERSION = 2;
+
+	void set_data(const PackedByteArray &p_data);
+	inline PackedByteArray get_data() const { return data; }
+
+	inline float get_duration() const { return duration; }
+	inline int get_callback_count() const { return callback_times.size(); }
+
+	MotionTimeline();
+};
+
+}
+
+#endif // GODUI_MOTION_TIMELINE_H
\ No newline at end of file
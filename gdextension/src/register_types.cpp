@@ -2,7 +2,15 @@
 
 #include "ui.h"
 #include "motion_ref.h"
+#include "motion_timeline.h"
 #include "draw_ref.h"
+#include "ease_table.h"
+#include "ui_text.h"
+#include "ui_lite.h"
+#include "ui_snapshot.h"
+#include "trace.h"
+#include "scene_pool.h"
+#include "shaped_text_cache.h"
 
 #include <gdextension_interface.h>
 #include <godot_cpp/core/defs.hpp>
@@ -16,7 +24,11 @@ void initialize_godui_module(ModuleInitializationLevel p_level) {
         case MODULE_INITIALIZATION_LEVEL_SCENE: {
             ClassDB::register_class<UI>();
             ClassDB::register_class<MotionRef>();
+            ClassDB::register_class<MotionTimeline>();
             ClassDB::register_class<DrawRef>();
+            ClassDB::register_class<UIText>();
+            ClassDB::register_class<UILite>();
+            ClassDB::register_class<UISnapshot>();
         } break;
     }
 }
@@ -24,7 +36,11 @@ void initialize_godui_module(ModuleInitializationLevel p_level) {
 void uninitialize_godui_module(ModuleInitializationLevel p_level) {
     switch (p_level) {
         case MODULE_INITIALIZATION_LEVEL_SCENE: {
-            
+            ScenePool::clear();
+            EaseTable::clear_cache();
+            UI::clear_builtin_classes();
+            ShapedTextCache::clear_cache();
+            Trace::free_buffer();
         } break;
     }
 }
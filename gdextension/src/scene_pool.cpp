@@ -0,0 +1,169 @@
+#include "scene_pool.h"
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+
+using namespace godot;
+
+HashMap<uint64_t, ScenePool::Pool> ScenePool::pools = HashMap<uint64_t, ScenePool::Pool>();
+LocalVector<int64_t> ScenePool::orphaned_tasks = LocalVector<int64_t>();
+BinaryMutex ScenePool::mutex;
+
+void ScenePool::instantiate(uint64_t p_scene_id) {
+	Ref<PackedScene> scene;
+	{
+		MutexLock lock(mutex);
+		HashMap<uint64_t, Pool>::Iterator pool = pools.find(p_scene_id);
+		if (!pool) return;
+		scene = pool->value.scene;
+	}
+
+	// The instance stays outside the tree, so building it doesn't need the main thread
+	Node *node = scene->instantiate();
+
+	MutexLock lock(mutex);
+	HashMap<uint64_t, Pool>::Iterator pool = pools.find(p_scene_id);
+	if (pool) {
+		pool->value.pending--;
+		// The target may have been lowered while this was building
+		if (node && pool->value.ready.size() < pool->value.target) {
+			pool->value.ready.push_back(node);
+			node = nullptr;
+		}
+		if (pool->value.target == 0 && pool->value.pending == 0) {
+			for (uint32_t i = 0; i < pool->value.tasks.size(); i++) orphaned_tasks.push_back(pool->value.tasks[i]);
+			pools.remove(pool);
+		}
+	}
+	if (node) memdelete(node);
+}
+
+void ScenePool::reap(LocalVector<int64_t> &r_tasks) {
+	// Every task has to be waited on once, finished ones are collected without blocking
+	WorkerThreadPool *wtp = WorkerThreadPool::get_singleton();
+	for (uint32_t i = 0; i < r_tasks.size();) {
+		if (wtp->is_task_completed(r_tasks[i])) {
+			wtp->wait_for_task_completion(r_tasks[i]);
+			r_tasks.remove_at_unordered(i);
+		} else {
+			i++;
+		}
+	}
+}
+
+void ScenePool::refill(Pool &p_pool) {
+	WorkerThreadPool *wtp = WorkerThreadPool::get_singleton();
+	uint64_t id = p_pool.scene->get_instance_id();
+	while (p_pool.ready.size() + p_pool.pending < p_pool.target) {
+		p_pool.pending++;
+		p_pool.tasks.push_back(wtp->add_task(callable_mp_static(&ScenePool::instantiate).bind(id), false, "Godui scene prewarm"));
+	}
+}
+
+void ScenePool::prewarm(const Ref<PackedScene> &p_scene, uint32_t p_count) {
+	ERR_FAIL_COND_MSG(p_scene.is_null(), "Scene is null");
+
+	LocalVector<int64_t> tasks;
+	LocalVector<Node *> excess;
+	{
+		MutexLock lock(mutex);
+		reap(orphaned_tasks);
+		uint64_t id = p_scene->get_instance_id();
+		HashMap<uint64_t, Pool>::Iterator pool = pools.find(id);
+		if (!pool) {
+			if (p_count == 0) return;
+			pool = pools.insert(id, Pool());
+			pool->value.scene = p_scene;
+		}
+
+		pool->value.target = p_count;
+		reap(pool->value.tasks);
+		while (pool->value.ready.size() > p_count) {
+			excess.push_back(pool->value.ready[pool->value.ready.size() - 1]);
+			pool->value.ready.resize(pool->value.ready.size() - 1);
+		}
+
+		// With tasks still building, the last one to finish drops the pool
+		if (p_count == 0 && pool->value.pending == 0) {
+			tasks = pool->value.tasks;
+			pools.remove(pool);
+		} else {
+			refill(pool->value);
+		}
+	}
+
+	WorkerThreadPool *wtp = WorkerThreadPool::get_singleton();
+	for (uint32_t i = 0; i < tasks.size(); i++) wtp->wait_for_task_completion(tasks[i]);
+	for (uint32_t i = 0; i < excess.size(); i++) memdelete(excess[i]);
+}
+
+Node *ScenePool::take(const Ref<PackedScene> &p_scene) {
+	MutexLock lock(mutex);
+	reap(orphaned_tasks);
+	HashMap<uint64_t, Pool>::Iterator pool = pools.find(p_scene->get_instance_id());
+	if (!pool) return nullptr;
+
+	Node *node = nullptr;
+	reap(pool->value.tasks);
+	if (pool->value.ready.size() > 0) {
+		node = pool->value.ready[pool->value.ready.size() - 1];
+		pool->value.ready.resize(pool->value.ready.size() - 1);
+		pool->value.hits++;
+	} else {
+		pool->value.misses++;
+	}
+
+	refill(pool->value);
+	return node;
+}
+
+Dictionary ScenePool::get_stats() {
+	MutexLock lock(mutex);
+
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	Dictionary scenes;
+	for (HashMap<uint64_t, Pool>::Iterator pool = pools.begin(); pool; ++pool) {
+		Dictionary stats;
+		stats["hits"] = pool->value.hits;
+		stats["misses"] = pool->value.misses;
+		stats["ready"] = pool->value.ready.size();
+		stats["target"] = pool->value.target;
+		uint64_t total = pool->value.hits + pool->value.misses;
+		stats["hit_rate"] = total > 0 ? (double)pool->value.hits / (double)total : 0.0;
+		scenes[pool->value.scene->get_path()] = stats;
+
+		hits += pool->value.hits;
+		misses += pool->value.misses;
+	}
+
+	Dictionary stats;
+	stats["hits"] = hits;
+	stats["misses"] = misses;
+	stats["hit_rate"] = hits + misses > 0 ? (double)hits / (double)(hits + misses) : 0.0;
+	stats["scenes"] = scenes;
+	return stats;
+}
+
+void ScenePool::clear() {
+	LocalVector<int64_t> tasks;
+	{
+		MutexLock lock(mutex);
+		tasks = orphaned_tasks;
+		orphaned_tasks.clear();
+		for (HashMap<uint64_t, Pool>::Iterator pool = pools.begin(); pool; ++pool) {
+			for (uint32_t i = 0; i < pool->value.tasks.size(); i++) tasks.push_back(pool->value.tasks[i]);
+			pool->value.tasks.clear();
+		}
+	}
+
+	// Running tasks finish outside the lock, they need it to hand their instance over
+	WorkerThreadPool *wtp = WorkerThreadPool::get_singleton();
+	for (uint32_t i = 0; i < tasks.size(); i++) wtp->wait_for_task_completion(tasks[i]);
+
+	MutexLock lock(mutex);
+	for (HashMap<uint64_t, Pool>::Iterator pool = pools.begin(); pool; ++pool) {
+		for (uint32_t i = 0; i < pool->value.ready.size(); i++) memdelete(pool->value.ready[i]);
+	}
+	pools.clear();
+}
\ No newline at end of file
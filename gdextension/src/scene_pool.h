@@ -0,0 +1,53 @@
+#ifndef GODUI_SCENE_POOL_H
+#define GODUI_SCENE_POOL_H
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/packed_scene.hpp>
+#include <godot_cpp/core/mutex.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+namespace godot {
+
+// Detached scene instances built on the worker threads ahead of 'UI::add' asking for them
+class ScenePool {
+	struct Pool {
+		Ref<PackedScene> scene;
+		LocalVector<Node *> ready;
+		LocalVector<int64_t> tasks;
+		uint32_t target;
+		uint32_t pending;
+		uint64_t hits;
+		uint64_t misses;
+
+		inline Pool() {
+			scene = Ref<PackedScene>();
+			ready = LocalVector<Node *>();
+			tasks = LocalVector<int64_t>();
+			target = 0;
+			pending = 0;
+			hits = 0;
+			misses = 0;
+		}
+	};
+
+	static HashMap<uint64_t, Pool> pools;
+	// Tasks of pools dropped from inside a task, waited on by the next call on the main thread
+	static LocalVector<int64_t> orphaned_tasks;
+	static BinaryMutex mutex;
+
+	static void instantiate(uint64_t p_scene_id);
+	static void reap(LocalVector<int64_t> &r_tasks);
+	static void refill(Pool &p_pool);
+
+public:
+	static void prewarm(const Ref<PackedScene> &p_scene, uint32_t p_count);
+	static Node *take(const Ref<PackedScene> &p_scene);
+	static Dictionary get_stats();
+	static void clear();
+};
+
+}
+
+#endif // GODUI_SCENE_POOL_H
\ No newline at end of file
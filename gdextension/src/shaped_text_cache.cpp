@@ -0,0 +1,65 @@
+#include "shaped_text_cache.h"
+#include <godot_cpp/classes/text_server.hpp>
+#include <godot_cpp/classes/text_server_manager.hpp>
+
+using namespace godot;
+
+HashMap<ShapedTextCache::Key, ShapedTextCache::Entry, ShapedTextCache::Key> ShapedTextCache::cache = HashMap<ShapedTextCache::Key, ShapedTextCache::Entry, ShapedTextCache::Key>();
+List<ShapedTextCache::Key> ShapedTextCache::lru = List<ShapedTextCache::Key>();
+uint32_t ShapedTextCache::capacity = 4096;
+
+void ShapedTextCache::evict(uint32_t p_size) {
+	Ref<TextServer> ts = TextServerManager::get_singleton()->get_primary_interface();
+
+	// Least recently drawn strings are at the back
+	while (cache.size() > p_size && lru.back()) {
+		List<Key>::Element *last = lru.back();
+		HashMap<Key, Entry, Key>::Iterator it = cache.find(last->get());
+		if (it) {
+			if (ts.is_valid()) ts->free_rid(it->value.shaped);
+			cache.remove(it);
+		}
+		lru.erase(last);
+	}
+}
+
+const ShapedTextCache::Entry *ShapedTextCache::get(const String &p_text, const Ref<Font> &p_font, int32_t p_font_size, const Dictionary &p_features) {
+	ERR_FAIL_COND_V_MSG(!p_font.is_valid(), nullptr, "Shaped text needs a valid font");
+
+	Key key;
+	key.text = p_text;
+	key.font_id = p_font->get_instance_id();
+	key.font_size = p_font_size;
+	key.features_hash = p_features.is_empty() ? 0 : p_features.hash();
+
+	HashMap<Key, Entry, Key>::Iterator it = cache.find(key);
+	if (it) {
+		lru.move_to_front(it->value.lru);
+		return &it->value;
+	}
+
+	Ref<TextServer> ts = TextServerManager::get_singleton()->get_primary_interface();
+	ERR_FAIL_COND_V_MSG(!ts.is_valid(), nullptr, "No text server available");
+
+	Entry entry;
+	entry.shaped = ts->create_shaped_text();
+	ts->shaped_text_add_string(entry.shaped, p_text, p_font->get_rids(), p_font_size, p_features);
+	entry.size = ts->shaped_text_get_size(entry.shaped);
+	entry.ascent = ts->shaped_text_get_ascent(entry.shaped);
+
+	// Evict before inserting so the returned entry can't be the one removed
+	evict(capacity > 0 ? capacity - 1 : 0);
+	entry.lru = lru.push_front(key);
+	return &cache.insert(key, entry)->value;
+}
+
+void ShapedTextCache::set_capacity(uint32_t p_capacity) {
+	capacity = MAX(p_capacity, 1u);
+	evict(capacity);
+}
+
+void ShapedTextCache::clear_cache() {
+	evict(0);
+	cache.clear();
+	lru.clear();
+}
\ No newline at end of file
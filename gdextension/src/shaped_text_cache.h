@@ -0,0 +1,72 @@
+#ifndef GODUI_SHAPED_TEXT_CACHE_H
+#define GODUI_SHAPED_TEXT_CACHE_H
+
+#include <godot_cpp/classes/font.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hashfuncs.hpp>
+#include <godot_cpp/templates/list.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+namespace godot {
+
+class ShapedTextCache {
+	struct Key {
+		String text;
+		uint64_t font_id;
+		int32_t font_size;
+		uint32_t features_hash;
+
+		static inline uint32_t hash(const Key &p_key) {
+			uint32_t h = hash_murmur3_one_32(p_key.text.hash());
+			h = hash_murmur3_one_64(p_key.font_id, h);
+			h = hash_murmur3_one_32(p_key.font_size, h);
+			h = hash_murmur3_one_32(p_key.features_hash, h);
+			return hash_fmix32(h);
+		}
+
+		inline bool operator==(const Key &p_other) const {
+			return font_id == p_other.font_id && font_size == p_other.font_size &&
+				features_hash == p_other.features_hash && text == p_other.text;
+		}
+
+		inline Key() {
+			text = String();
+			font_id = 0;
+			font_size = 0;
+			features_hash = 0;
+		}
+	};
+
+public:
+	struct Entry {
+		RID shaped;
+		Vector2 size;
+		float ascent;
+		List<Key>::Element *lru;
+
+		inline Entry() {
+			shaped = RID();
+			size = Vector2();
+			ascent = 0.0;
+			lru = nullptr;
+		}
+	};
+
+private:
+	static HashMap<Key, Entry, Key> cache;
+	static List<Key> lru;
+	static uint32_t capacity;
+
+	static void evict(uint32_t p_size);
+
+public:
+	// Entries stay valid until the next call, draw them right away instead of keeping them around
+	static const Entry *get(const String &p_text, const Ref<Font> &p_font, int32_t p_font_size, const Dictionary &p_features = Dictionary());
+	static void set_capacity(uint32_t p_capacity);
+	static inline uint32_t get_size() { return cache.size(); }
+	static void clear_cache();
+};
+
+}
+
+#endif // GODUI_SHAPED_TEXT_CACHE_H
\ No newline at end of file
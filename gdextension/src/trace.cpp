@@ -0,0 +1,120 @@
+#include "trace.h"
+#include "ui.h"
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/memory.hpp>
+
+#include <atomic>
+
+using namespace godot;
+
+SafeFlag Trace::enabled;
+SafeNumeric<uint64_t> Trace::head;
+Trace::Event *Trace::events = nullptr;
+uint32_t Trace::capacity = 0;
+
+uint64_t Trace::now() {
+	return Time::get_singleton()->get_ticks_usec();
+}
+
+void Trace::record(const char *p_name, uint64_t p_begin, const UI *p_ui, uint32_t p_nodes, uint32_t p_ops) {
+	if (!events) return;
+
+	uint64_t end = now();
+	// Built before claiming a slot so the slot is only held for the copies below
+	CharString label = p_ui ? p_ui->trace_label().utf8() : CharString();
+	uint64_t idx = head.postincrement();
+	Event &event = events[idx & (capacity - 1)];
+
+	// Seqlock write, the fence keeps the field writes from moving above the slot being claimed
+	event.sequence.set(0);
+	std::atomic_thread_fence(std::memory_order_release);
+	event.name = p_name;
+	event.begin = p_begin;
+	event.duration = end - p_begin;
+	event.thread = OS::get_singleton()->get_thread_caller_id();
+	event.nodes = p_nodes;
+	event.ops = p_ops;
+
+	int64_t length = MIN(label.length(), (int64_t)TRACE_LABEL_SIZE - 1);
+	if (length > 0) memcpy(event.label, label.get_data(), length);
+	event.label[length] = 0;
+
+	event.sequence.set(idx + 1);
+}
+
+void Trace::set_enabled(bool p_enabled, uint32_t p_capacity) {
+	// Rounded up to a power of two so slots are picked with a mask
+	uint32_t size = 1;
+	while (size < p_capacity) size <<= 1;
+
+	if (p_enabled && size != capacity) {
+		ERR_FAIL_COND_MSG(enabled.is_set(), "Disable tracing before changing the buffer capacity");
+		free_buffer();
+		events = memnew_arr(Event, size);
+		capacity = size;
+		clear();
+	}
+
+	enabled.set_to(p_enabled);
+}
+
+Error Trace::dump(const String &p_path) {
+	ERR_FAIL_COND_V_MSG(!events, ERR_UNCONFIGURED, "Tracing was never enabled");
+
+	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE);
+	ERR_FAIL_COND_V_MSG(file.is_null(), FileAccess::get_open_error(), vformat("Couldn't open '%s' to write the trace", p_path));
+
+	uint64_t last = head.get();
+	uint64_t first = last > capacity ? last - capacity : 0;
+	uint64_t pid = OS::get_singleton()->get_process_id();
+
+	// Chrome trace event format, complete events nest by time so recursive phases show up as a flame graph
+	file->store_string("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	bool first_event = true;
+	for (uint64_t i = first; i < last; i++) {
+		Event &slot = events[i & (capacity - 1)];
+		if (slot.sequence.get() != i + 1) continue;
+
+		Event event;
+		event.name = slot.name;
+		event.begin = slot.begin;
+		event.duration = slot.duration;
+		event.thread = slot.thread;
+		event.nodes = slot.nodes;
+		event.ops = slot.ops;
+		memcpy(event.label, slot.label, TRACE_LABEL_SIZE);
+		event.label[TRACE_LABEL_SIZE - 1] = 0;
+
+		// A writer wrapped around while copying, the event is torn
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.get() != i + 1) continue;
+
+		file->store_string(vformat(
+			"%s\n{\"name\":\"%s\",\"cat\":\"godui\",\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":%d,\"tid\":%d,\"args\":{\"ui\":%s,\"nodes\":%d,\"ops\":%d}}",
+			first_event ? "" : ",", event.name, (int64_t)event.begin, (int64_t)event.duration, (int64_t)pid, (int64_t)event.thread,
+			JSON::stringify(String::utf8(event.label)), event.nodes, event.ops
+		));
+		first_event = false;
+	}
+	file->store_string("\n]}\n");
+
+	return OK;
+}
+
+void Trace::clear() {
+	for (uint32_t i = 0; i < capacity; i++) {
+		events[i].sequence.set(0);
+	}
+	head.set(0);
+}
+
+void Trace::free_buffer() {
+	enabled.clear();
+	if (events) memdelete_arr(events);
+	events = nullptr;
+	capacity = 0;
+	head.set(0);
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef GODUI_TRACE_H
+#define GODUI_TRACE_H
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/templates/safe_refcount.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+// Labels are truncated to fit the fixed size events, the ring buffer never allocates while recording
+#define TRACE_LABEL_SIZE 64
+
+namespace godot {
+
+class UI;
+
+class Trace {
+	struct Event {
+		const char *name;
+		uint64_t begin;
+		uint64_t duration;
+		uint64_t thread;
+		uint32_t nodes;
+		uint32_t ops;
+		char label[TRACE_LABEL_SIZE];
+		// Index + 1 once the event is fully written, 0 while a writer owns the slot
+		SafeNumeric<uint64_t> sequence;
+	};
+
+	static SafeFlag enabled;
+	static SafeNumeric<uint64_t> head;
+	static Event *events;
+	static uint32_t capacity;
+
+public:
+	static inline bool is_enabled() { return enabled.is_set(); }
+	static uint64_t now();
+	static void record(const char *p_name, uint64_t p_begin, const UI *p_ui, uint32_t p_nodes, uint32_t p_ops);
+
+	static void set_enabled(bool p_enabled, uint32_t p_capacity);
+	static Error dump(const String &p_path);
+	static void clear();
+	static void free_buffer();
+};
+
+// Records a complete event when it goes out of scope, only the enabled check runs when tracing is off.
+// Holds plain data only, the UI's label is built by 'Trace::record' for active scopes
+class TraceScope {
+	const char *name;
+	const UI *ui;
+	uint64_t begin;
+
+public:
+	uint32_t nodes;
+	uint32_t ops;
+	bool active;
+
+	inline TraceScope(const char *p_name, const UI *p_ui) {
+		name = p_name;
+		ui = p_ui;
+		begin = 0;
+		nodes = 0;
+		ops = 0;
+		active = Trace::is_enabled();
+		if (active) begin = Trace::now();
+	}
+
+	inline ~TraceScope() {
+		if (active) Trace::record(name, begin, ui, nodes, ops);
+	}
+};
+
+}
+
+#define GODUI_TRACE_SCOPE(m_var, m_name, m_ui) TraceScope m_var(m_name, m_ui)
+
+#endif // GODUI_TRACE_H
\ No newline at end of file
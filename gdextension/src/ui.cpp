@@ -1,7 +1,11 @@
 #include "ui.h"
 #include "util.h"
 #include "unit.h"
+#include "shaped_text_cache.h"
+#include "trace.h"
+#include "scene_pool.h"
 
+#include <godot_cpp/core/math.hpp>
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/classes/random_number_generator.hpp>
@@ -12,10 +16,23 @@
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/theme_db.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/classes/class_db_singleton.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/input_event_mouse_button.hpp>
+#include <godot_cpp/classes/input_event_mouse_motion.hpp>
+#include <godot_cpp/classes/text_server.hpp>
+#include <godot_cpp/classes/text_server_manager.hpp>
+
+// Below this many awake motions the thread pool overhead outweighs the evaluation itself
+#define MOTION_PARALLEL_THRESHOLD 64
+#define MOTION_CHUNK_SIZE 32
 
 using namespace godot;
 
 HashMap<String, Object *> UI::builtin_scripts = HashMap<String, Object *>();
+HashMap<StringName, bool> UI::builtin_classes = HashMap<StringName, bool>();
+bool UI::motion_threads = true;
 
 void UI::_notification(int p_what) {
 	switch (p_what) {
@@ -33,6 +50,7 @@ void UI::_notification(int p_what) {
 }
 
 void UI::before_draw() {
+	GODUI_TRACE_SCOPE(trace, "draw_update", this);
 	draw_update(node->get_process_delta_time());
 }
 
@@ -76,9 +94,11 @@ void UI::check_update() {
 	}
 
 	if (repaint) {
+		GODUI_TRACE_SCOPE(trace, "ui_update", this);
 		pre_update();
 		ui_process();
 		post_update();
+		if (trace.active) trace.nodes = node->get_child_count();
 	}
 }
 
@@ -91,19 +111,25 @@ void UI::pre_update() {
 		}
 	}
 	
+	// Every event has to be declared again, the forwarding connection is tracked apart in 'connected'
 	for (HashMap<String, SignalInfo>::Iterator signal = signals.begin(); signal; ++signal) {
-		if (!signal->value.target.is_null()) {
-			signal->value.disconnect = true;
-		}
+		signal->value.disconnect = true;
 	}
 
 	if (node_motion.is_valid()) {
 		node_motion->clear();
 	}
 
+	shared_motion_stale = shared_motion.is_valid();
+
+	// Lite items are rebuilt from scratch, post_update compares them with what is drawn
+	lite_items.clear();
+	lite_events.clear();
+
 	node->set_block_signals(true);
 
 	child_idx = 0;
+	reconciling = true;
 }
 
 void UI::ui_process() {
@@ -114,14 +140,25 @@ void UI::ui_process() {
 		}
 	}
 	repaint = false;
-	if (!update_callable.is_null()) update_callable.call(this);
+	if (!update_callable.is_null()) {
+		GODUI_TRACE_SCOPE(trace, "ui_process", this);
+		update_callable.call(this);
+		if (trace.active) {
+			trace.nodes = node->get_child_count();
+			trace.ops = child_idx;
+		}
+	}
 }
 
 void UI::post_update() {
+	GODUI_TRACE_SCOPE(trace, "post_update", this);
+	uint32_t removed = 0;
+
 	for (UITypeCollection::Iterator type = types.begin(); type; ++type) {
 		for (UIChildrenCollection::Iterator child = type->value.children.begin(); child; ++child) {
 			child->value->post_update();
 			if (child->value->deletion) {
+				removed++;
 				child->value->remove();
 				if (!child->value->persist) {
 					child->value->del();
@@ -131,34 +168,63 @@ void UI::post_update() {
 		}
 	}
 
+	UI *ui_root = root ? root : this;
 	for (HashMap<String, SignalInfo>::Iterator signal = signals.begin(); signal; ++signal) {
-		if (signal->value.disconnect) {
-			node->disconnect(signal->key, signal->value.target);
+		if (signal->value.disconnect && !signal->value.target.is_null()) {
+			// The forwarding connection stays, events without a handler are dropped by the root
+			EventKey key;
+			key.id = node->get_instance_id();
+			key.signal = signal->key;
+			ui_root->event_handlers.erase(key);
 			signal->value.target = Callable();
-			signal->value.disconnect = false;
 		}
 	}
+
+	if (node_motion.is_valid()) {
+		node_motion->prune_springs();
+	}
+
+	if (shared_motion_stale) {
+		shared_motion->unsubscribe(node);
+		shared_motion = Ref<MotionRef>();
+		shared_motion_stale = false;
+	}
+
+	if (lite_items.size() > 0 || lite_drawn.size() > 0) {
+		lite_commit();
+	}
+
+	// Layout written during the pass lands here, after the parent finished adding and ordering its children
+	reconciling = false;
+	if (layout_pending) apply_layout(Object::cast_to<Control>(node));
 	
 	node->set_block_signals(false);
 
 	debug_prev_update_elapsed = 0.0;
+
+	// Every UI runs this, only the ones that removed nodes are worth an event
+	if (trace.active) {
+		trace.active = removed > 0;
+		trace.nodes = node->get_child_count();
+		trace.ops = removed;
+	}
 }
 
 void UI::remove() {
 	parent->node->remove_child(node);
 
-	for (HashMap<String, SignalInfo>::Iterator signal = signals.begin(); signal; ++signal) {
-		if (!signal->value.target.is_null()) {
-			node->disconnect(signal->key, signal->value.target);
-		}
-	}
+	clear_events();
 
 	if (node_motion.is_valid()) {
 		node_motion->clear();
+		node_motion->prune_springs();
 		node_motion->reset();
 	}
 
-	signals.clear();
+	if (shared_motion.is_valid()) {
+		shared_motion->unsubscribe(node);
+		shared_motion = Ref<MotionRef>();
+	}
 
 	inside = false;
 	deletion = false;
@@ -172,21 +238,493 @@ void UI::del() {
 		}
 	}
 
+	if (shared_motion.is_valid()) {
+		shared_motion->unsubscribe(node);
+		shared_motion = Ref<MotionRef>();
+	}
+
+	// The forwarding connections go away with the node
+	clear_events();
+	signals.clear();
+
 	node->queue_free();
 	node = nullptr;
 }
 
-void UI::idle_update(float p_delta) {
-	for (UITypeCollection::Iterator type = types.begin(); type; ++type) {
-		for (UIChildrenCollection::Iterator child = type->value.children.begin(); child; ++child) {
-			child->value->idle_update(p_delta);
+void UI::clear_events() {
+	UI *ui_root = root ? root : this;
+	for (HashMap<String, SignalInfo>::Iterator signal = signals.begin(); signal; ++signal) {
+		signal->value.disconnect = true;
+		if (signal->value.target.is_null()) continue;
+
+		EventKey key;
+		key.id = node->get_instance_id();
+		key.signal = signal->key;
+		ui_root->event_handlers.erase(key);
+		signal->value.target = Callable();
+	}
+}
+
+Variant UI::dispatch_event(const Variant **p_args, GDExtensionInt p_argc, GDExtensionCallError &r_error) {
+	r_error.error = GDEXTENSION_CALL_OK;
+	if (p_argc < 2) {
+		r_error.error = GDEXTENSION_CALL_ERROR_TOO_FEW_ARGUMENTS;
+		r_error.expected = 2;
+		return Variant();
+	}
+
+	// The node's instance id and the signal name are bound after the signal's own arguments
+	EventKey key;
+	key.id = (uint64_t)*p_args[p_argc - 2];
+	key.signal = *p_args[p_argc - 1];
+
+	HashMap<EventKey, Callable, EventKey>::Iterator handler = event_handlers.find(key);
+	if (!handler || !handler->value.is_valid()) return Variant();
+
+	Array args;
+	args.resize(p_argc - 2);
+	for (GDExtensionInt i = 0; i < p_argc - 2; i++) {
+		args[i] = *p_args[i];
+	}
+
+	return handler->value.callv(args);
+}
+
+void UI::collect_motions(float p_delta, LocalVector<Ref<MotionRef>> &r_motions) {
+	UI *ui_root = root ? root : this;
+	CanvasItem *canvas_item = Object::cast_to<CanvasItem>(node);
+
+	// Descendants of a hidden node are skipped, their motions catch up with the clock once shown again.
+	// The hidden node's own motion still runs, it may be the one that makes it visible
+	bool hidden = inside && canvas_item && ui_root->motion_skip_hidden && !canvas_item->is_visible_in_tree();
+
+	if (!hidden) {
+		for (UITypeCollection::Iterator type = types.begin(); type; ++type) {
+			for (UIChildrenCollection::Iterator child = type->value.children.begin(); child; ++child) {
+				child->value->collect_motions(p_delta, r_motions);
+			}
 		}
 	}
 
 	if (inside && node_motion.is_valid()) {
-		node_motion->time += p_delta;
-		node_motion->animate();
+		MotionRef *motion = node_motion.ptr();
+		float step;
+
+		if (motion->sleeping) {
+			// Keep following the clock so waking up doesn't skip ahead
+			motion->clock = ui_root->motion_clock;
+		} else if (step_motion_clock(motion->clock, motion->clock_resync, p_delta, step)) {
+			motion->time += step;
+			motion->step += step;
+			r_motions.push_back(node_motion);
+		}
+	}
+
+	if (inside && shared_motion.is_valid()) {
+		// Subscribers keep their own stamp, so a hidden or throttled one catches up like a node motion
+		int64_t idx = shared_motion->find_subscriber(node);
+		if (idx != -1) {
+			MotionRef::Subscriber &sub = shared_motion->subscribers.write[idx];
+			float step;
+
+			if (shared_motion->sleeping || sub.sleeping) {
+				sub.clock = ui_root->motion_clock;
+			} else if (step_motion_clock(sub.clock, sub.clock_resync, p_delta, step) && shared_motion->advance_shared(idx, step)) {
+				ui_root->shared_motion_batch.push_back(shared_motion);
+			}
+		}
+	}
+}
+
+bool UI::step_motion_clock(double &r_clock, bool &r_resync, float p_delta, float &r_step) {
+	double elapsed = ui_root->motion_clock - r_clock;
+	if (
+		!r_resync && ui_root->motion_offscreen_rate > 0.0 &&
+		elapsed < 1.0 / ui_root->motion_offscreen_rate && is_offscreen()
+	) return false;
+
+	r_step = r_resync ? p_delta : (float)elapsed;
+	r_clock = ui_root->motion_clock;
+	r_resync = false;
+	return true;
+}
+
+void UI::draw_batch_update() {
+	CanvasItem *canvas_item = Object::cast_to<CanvasItem>(node);
+	if (!canvas_item->is_inside_tree()) {
+		draw_batch_members.clear();
+		return;
+	}
+	Transform2D inv = canvas_item->get_global_transform().affine_inverse();
+
+	// Only merge again when a member recorded, moved, changed visibility or left the batch
+	bool dirty = draw_batch_members.size() != draw_batch_count;
+	for (uint32_t i = 0; i < draw_batch_members.size(); i++) {
+		DrawRef *member = draw_batch_members[i];
+		// Persisted members removed from the tree still report in, they're hidden without reading their transform
+		bool visible = member->node->is_inside_tree() && member->node->is_visible_in_tree();
+		Transform2D tr = visible ? inv * member->node->get_global_transform() : member->batch_transform;
+		if (member->batch_dirty || tr != member->batch_transform || visible != member->batch_visible) {
+			member->batch_transform = tr;
+			member->batch_visible = visible;
+			member->batch_dirty = false;
+			dirty = true;
+		}
+	}
+	draw_batch_count = draw_batch_members.size();
+
+	if (dirty) {
+		uint32_t point_count = 0;
+		uint32_t index_count = 0;
+		for (uint32_t i = 0; i < draw_batch_members.size(); i++) {
+			if (!draw_batch_members[i]->batch_visible) continue;
+			point_count += draw_batch_members[i]->batch_points.size();
+			index_count += draw_batch_members[i]->batch_indices.size();
+		}
+
+		PackedVector2Array points;
+		PackedColorArray colors;
+		PackedInt32Array indices;
+		points.resize(point_count);
+		colors.resize(point_count);
+		indices.resize(index_count);
+		Vector2 *pw = points.ptrw();
+		Color *cw = colors.ptrw();
+		int32_t *iw = indices.ptrw();
+
+		int32_t base = 0;
+		uint32_t idx = 0;
+		for (uint32_t i = 0; i < draw_batch_members.size(); i++) {
+			DrawRef *member = draw_batch_members[i];
+			if (!member->batch_visible) continue;
+
+			const Transform2D &tr = member->batch_transform;
+			uint32_t count = member->batch_points.size();
+			for (uint32_t j = 0; j < count; j++) {
+				pw[base + j] = tr.xform(member->batch_points[j]);
+				cw[base + j] = member->batch_colors[j];
+			}
+			for (uint32_t j = 0; j < member->batch_indices.size(); j++) {
+				iw[idx++] = base + member->batch_indices[j];
+			}
+			base += count;
+		}
+
+		RenderingServer *rs = RenderingServer::get_singleton();
+		rs->canvas_item_clear(draw_batch_item);
+		rs->canvas_item_set_draw_index(draw_batch_item, node->get_child_count());
+		if (index_count > 0) {
+			rs->canvas_item_add_triangle_array(draw_batch_item, indices, points, colors);
+		}
+	}
+
+	draw_batch_members.clear();
+}
+
+void UI::lite_commit() {
+	if (lite_items.size() == lite_drawn.size()) {
+		bool changed = false;
+		for (uint32_t i = 0; i < lite_items.size() && !changed; i++) {
+			changed = !(lite_items[i] == lite_drawn[i]);
+		}
+		if (!changed) return;
+	}
+
+	lite_drawn = lite_items;
+	lite_cells.clear();
+	lite_explicit.clear();
+	for (uint32_t i = 0; i < lite_drawn.size(); i++) {
+		if (lite_drawn[i].flags & LITE_HAS_RECT) {
+			lite_explicit.push_back(i);
+		} else {
+			lite_drawn[i].cell = lite_cells.size();
+			lite_cells.push_back(i);
+		}
+	}
+	if (lite_hover >= (int64_t)lite_drawn.size()) lite_hover = -1;
+	if (lite_pressed >= (int64_t)lite_drawn.size()) lite_pressed = -1;
+
+	lite_update();
+}
+
+void UI::lite_update() {
+	Control *control = Object::cast_to<Control>(node);
+	RenderingServer *rs = RenderingServer::get_singleton();
+
+	if (!lite_canvas_item.is_valid()) {
+		lite_canvas_item = rs->canvas_item_create();
+		rs->canvas_item_set_parent(lite_canvas_item, control->get_canvas_item());
+		lite_hover_item = rs->canvas_item_create();
+		rs->canvas_item_set_parent(lite_hover_item, lite_canvas_item);
+	}
+
+	Ref<Font> font = control->get_theme_font("font", "Label");
+	int32_t font_size = control->get_theme_font_size("font_size", "Label");
+	Color font_color = control->get_theme_color("font_color", "Label");
+
+	// Every item goes into one canvas item, rebuilt only when an item actually changed
+	rs->canvas_item_clear(lite_canvas_item);
+	for (uint32_t i = 0; i < lite_drawn.size(); i++) {
+		lite_draw_item(lite_canvas_item, lite_drawn[i], lite_item_rect(i), lite_drawn[i].color, font, font_size, font_color);
 	}
+
+	// The owner is sized to fit the grid so it still lays out inside containers
+	int32_t columns = MAX(lite_columns, 1);
+	int64_t rows = (lite_cells.size() + columns - 1) / columns;
+	Vector2 extent = Vector2(
+		rows > 0 ? MIN((int64_t)columns, (int64_t)lite_cells.size()) * (lite_cell_size.x + lite_separation.x) - lite_separation.x : 0.0,
+		rows > 0 ? rows * (lite_cell_size.y + lite_separation.y) - lite_separation.y : 0.0
+	);
+	if (control->get_custom_minimum_size() != extent) control->set_custom_minimum_size(extent);
+
+	lite_hover_update();
+}
+
+void UI::lite_hover_update() {
+	if (!lite_hover_item.is_valid()) return;
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	rs->canvas_item_clear(lite_hover_item);
+
+	// Hovering only redraws the hovered item on top instead of the whole grid
+	if (lite_hover < 0 || !(lite_drawn[lite_hover].flags & LITE_HAS_HOVER)) return;
+
+	Control *control = Object::cast_to<Control>(node);
+	const LiteItem &item = lite_drawn[lite_hover];
+	lite_draw_item(
+		lite_hover_item, item, lite_item_rect(lite_hover), item.hover_color,
+		control->get_theme_font("font", "Label"), control->get_theme_font_size("font_size", "Label"), control->get_theme_color("font_color", "Label")
+	);
+}
+
+void UI::lite_draw_item(const RID &p_canvas_item, const LiteItem &p_item, const Rect2 &p_rect, const Color &p_color, const Ref<Font> &p_font, int32_t p_font_size, const Color &p_font_color) {
+	if (p_color.a > 0.0) {
+		RenderingServer::get_singleton()->canvas_item_add_rect(p_canvas_item, p_rect, p_color);
+	}
+
+	if (p_item.text.is_empty()) return;
+
+	const ShapedTextCache::Entry *entry = ShapedTextCache::get(p_item.text, p_font, p_font_size);
+	if (!entry) return;
+
+	Vector2 pos = p_rect.position + Vector2(4.0, (p_rect.size.y - entry->size.y) * 0.5 + entry->ascent);
+	Color color = (p_item.flags & LITE_HAS_FONT_COLOR) ? p_item.font_color : p_font_color;
+	TextServerManager::get_singleton()->get_primary_interface()->shaped_text_draw(entry->shaped, p_canvas_item, pos.round(), -1, MAX(p_rect.size.x - 8.0, 0.0), color);
+}
+
+void UI::lite_emit(int64_t p_item, uint64_t p_event) {
+	if (p_item < 0) return;
+
+	HashMap<uint64_t, Callable>::Iterator target = lite_events.find(((uint64_t)p_item << 2) | p_event);
+	if (target && target->value.is_valid()) target->value.call();
+}
+
+void UI::lite_gui_input(const Ref<InputEvent> &p_event) {
+	Ref<InputEventMouseMotion> motion = p_event;
+	if (motion.is_valid()) {
+		int64_t hit = lite_hit(motion->get_position());
+		if (hit != lite_hover) {
+			int64_t prev = lite_hover;
+			lite_hover = hit;
+			lite_hover_update();
+			lite_emit(prev, LITE_EVENT_MOUSE_EXITED);
+			lite_emit(hit, LITE_EVENT_MOUSE_ENTERED);
+		}
+		return;
+	}
+
+	Ref<InputEventMouseButton> button = p_event;
+	if (button.is_valid() && button->get_button_index() == MOUSE_BUTTON_LEFT) {
+		int64_t hit = lite_hit(button->get_position());
+		bool handled = hit >= 0 && lite_events.has(((uint64_t)hit << 2) | LITE_EVENT_PRESSED);
+
+		// Like a button, pressed only fires when released over the item the press started on
+		if (button->is_pressed()) {
+			lite_pressed = hit;
+			if (handled) Object::cast_to<Control>(node)->accept_event();
+			return;
+		}
+
+		int64_t pressed = lite_pressed;
+		lite_pressed = -1;
+		if (handled && hit == pressed) {
+			Object::cast_to<Control>(node)->accept_event();
+			lite_emit(hit, LITE_EVENT_PRESSED);
+		}
+	}
+}
+
+void UI::lite_mouse_exited() {
+	if (lite_hover < 0) return;
+
+	int64_t prev = lite_hover;
+	lite_hover = -1;
+	lite_hover_update();
+	lite_emit(prev, LITE_EVENT_MOUSE_EXITED);
+}
+
+Rect2 UI::lite_item_rect(uint32_t p_item) const {
+	const LiteItem &item = lite_drawn[p_item];
+	if (item.flags & LITE_HAS_RECT) return item.rect;
+
+	int32_t columns = MAX(lite_columns, 1);
+	Vector2 pitch = lite_cell_size + lite_separation;
+	return Rect2(Vector2((item.cell % columns) * pitch.x, (item.cell / columns) * pitch.y), lite_cell_size);
+}
+
+int64_t UI::lite_hit(const Vector2 &p_position) const {
+	// The grid cell under the cursor is the only grid candidate
+	int64_t hit = -1;
+	int32_t columns = MAX(lite_columns, 1);
+	Vector2 pitch = lite_cell_size + lite_separation;
+	if (pitch.x > 0.0 && pitch.y > 0.0 && p_position.x >= 0.0 && p_position.y >= 0.0) {
+		int64_t column = (int64_t)(p_position.x / pitch.x);
+		int64_t cell = (int64_t)(p_position.y / pitch.y) * columns + column;
+		if (column < columns && cell < (int64_t)lite_cells.size() && lite_item_rect(lite_cells[cell]).has_point(p_position)) {
+			hit = lite_cells[cell];
+		}
+	}
+
+	// Items with their own rect can be anywhere, only the ones drawn above the grid hit are checked
+	for (int64_t i = (int64_t)lite_explicit.size() - 1; i >= 0; i--) {
+		if ((int64_t)lite_explicit[i] < hit) break;
+		if (lite_drawn[lite_explicit[i]].rect.has_point(p_position)) return lite_explicit[i];
+	}
+	return hit;
+}
+
+String UI::trace_label() const {
+	// Keys from the root down, the root itself is named after its node
+	String label;
+	for (const UI *ui = this; ui; ui = ui->parent) {
+		String part = ui->parent ? ui->index : String(ui->node->get_name());
+		label = label.is_empty() ? part : part + "/" + label;
+	}
+	return label;
+}
+
+bool UI::is_offscreen() const {
+	Control *control = Object::cast_to<Control>(node);
+	if (!control) return false;
+
+	Rect2 rect = control->get_global_transform_with_canvas().xform(Rect2(Vector2(), control->get_size()));
+	return !control->get_viewport_rect().intersects(rect);
+}
+
+void UI::evaluate_motions(uint32_t p_chunk) {
+	uint32_t from = p_chunk * MOTION_CHUNK_SIZE;
+	uint32_t to = MIN(from + MOTION_CHUNK_SIZE, motion_batch.size());
+	for (uint32_t i = from; i < to; i++) {
+		motion_batch[i]->evaluate();
+	}
+}
+
+void UI::idle_update(float p_delta) {
+	if (motion_paused) return;
+
+	GODUI_TRACE_SCOPE(trace, "idle_update", this);
+
+	p_delta *= motion_time_scale;
+
+	// Fixed step quantizes the clock, timelines are pure functions of time so a single evaluation covers every step
+	if (motion_fixed_step > 0.0) {
+		motion_step_accum += p_delta;
+		float steps = Math::floor(motion_step_accum / motion_fixed_step);
+		if (steps < 1.0) return;
+		p_delta = steps * motion_fixed_step;
+		motion_step_accum -= p_delta;
+	}
+
+	motion_clock += p_delta;
+
+	motion_batch.clear();
+	collect_motions(p_delta, motion_batch);
+
+	for (uint32_t i = 0; i < shared_motion_batch.size(); i++) {
+		shared_motion_batch[i]->animate_shared();
+	}
+	shared_motion_batch.clear();
+
+	uint32_t count = motion_batch.size();
+	trace.ops = count;
+	if (count == 0) return;
+
+	// Keyframe math runs on the worker threads, only setting the values has to stay on the main thread
+	if (UI::motion_threads && count >= MOTION_PARALLEL_THRESHOLD) {
+		uint32_t chunks = (count + MOTION_CHUNK_SIZE - 1) / MOTION_CHUNK_SIZE;
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		int64_t group = pool->add_group_task(callable_mp(this, &UI::evaluate_motions), chunks, -1, true, "Godui motions");
+		pool->wait_for_group_task_completion(group);
+	} else {
+		for (uint32_t i = 0; i < count; i++) {
+			motion_batch[i]->evaluate();
+		}
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		motion_batch[i]->apply();
+	}
+
+	motion_batch.clear();
+}
+
+void UI::set_motion_threads(bool p_enabled) {
+	UI::motion_threads = p_enabled;
+}
+
+void UI::set_tracing(bool p_enabled, int p_capacity) {
+	ERR_FAIL_COND_MSG(p_capacity < 1, "Trace capacity must be at least 1");
+	Trace::set_enabled(p_enabled, p_capacity);
+}
+
+void UI::prewarm_scene(const Ref<PackedScene> &p_scene, int p_count) {
+	ERR_FAIL_COND_MSG(p_count < 0, "Prewarm count must be greater or equal 0");
+	ScenePool::prewarm(p_scene, p_count);
+}
+
+Dictionary UI::get_scene_pool_stats() {
+	return ScenePool::get_stats();
+}
+
+void UI::clear_scene_pools() {
+	ScenePool::clear();
+}
+
+Error UI::dump_trace(const String &p_path) {
+	return Trace::dump(p_path);
+}
+
+void UI::clear_trace() {
+	Trace::clear();
+}
+
+void UI::set_text_cache_size(int p_size) {
+	ERR_FAIL_COND_MSG(p_size < 1, "Text cache size must be at least 1");
+	ShapedTextCache::set_capacity(p_size);
+}
+
+Transform2D UI::animate_rect_transform(float p_delta) {
+	Control *control = Object::cast_to<Control>(node);
+	Rect2 curr = control->get_rect();
+	float t = p_delta * rect_animation_speed;
+	t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+
+	if (rect_current.size.x < 0.0) {
+		rect_current = curr;
+	}
+
+	rect_current.position += (curr.position - rect_current.position) * t;
+	rect_current.size += (curr.size - rect_current.size) * t;
+
+	if (ABS(rect_current.position.x - curr.position.x) < 0.5) rect_current.position.x = curr.position.x;
+	if (ABS(rect_current.position.y - curr.position.y) < 0.5) rect_current.position.y = curr.position.y;
+	if (ABS(rect_current.size.x - curr.size.x) < 0.5) rect_current.size.x = curr.size.x;
+	if (ABS(rect_current.size.y - curr.size.y) < 0.5) rect_current.size.y = curr.size.y;
+
+	Vector2 delta_pos = rect_current.position - curr.position;
+	Vector2 delta_scale = rect_current.size / curr.size;
+
+	return Transform2D(Vector2(delta_scale.x, 0.0), Vector2(0.0, delta_scale.y), delta_pos);
 }
 
 void UI::draw_update(float p_delta) {
@@ -198,42 +736,53 @@ void UI::draw_update(float p_delta) {
 
 	debug_prev_update_elapsed += p_delta / 0.25;
 
-	if (rect_animation_speed > 0.0) {
-		Control *control = Object::cast_to<Control>(node);
-		Rect2 curr = control->get_rect();
-		Transform2D tr = control->get_transform();
-		RID rid = control->get_canvas_item();
-		float t = p_delta * rect_animation_speed;
-		t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
-
-		if (rect_current.size.x < 0.0) {
-			rect_current = curr;
-		}
-
-		rect_current.position += (curr.position - rect_current.position) * t;
-		rect_current.size += (curr.size - rect_current.size) * t;
+	CanvasItem *canvas_item = Object::cast_to<CanvasItem>(node);
+	bool visual_motion = canvas_item && node_motion.is_valid() && node_motion->visual_enabled;
 
-		if (ABS(rect_current.position.x - curr.position.x) < 0.5) rect_current.position.x = curr.position.x;
-		if (ABS(rect_current.position.y - curr.position.y) < 0.5) rect_current.position.y = curr.position.y;
-		if (ABS(rect_current.size.x - curr.size.x) < 0.5) rect_current.size.x = curr.size.x;
-		if (ABS(rect_current.size.y - curr.size.y) < 0.5) rect_current.size.y = curr.size.y;
+	if (rect_animation_speed > 0.0 || visual_motion) {
+		Transform2D tr = canvas_item->get_transform();
+		RID rid = canvas_item->get_canvas_item();
 
-		Vector2 delta_pos = rect_current.position - curr.position;
-		Vector2 delta_scale = rect_current.size / curr.size;
+		if (rect_animation_speed > 0.0) {
+			tr *= animate_rect_transform(p_delta);
+		}
 
-		tr *= Transform2D(Vector2(delta_scale.x, 0.0), Vector2(0.0, delta_scale.y), delta_pos);
+		// Visual-only motion channels never touch the node's properties, so no layout is invalidated
+		if (visual_motion) {
+			Control *control = Object::cast_to<Control>(node);
+			tr *= node_motion->get_visual_transform(control ? control->get_pivot_offset() : Vector2());
+			RenderingServer::get_singleton()->canvas_item_set_modulate(rid, canvas_item->get_modulate() * node_motion->visual_modulate);
+		}
 
 		RenderingServer::get_singleton()->canvas_item_set_transform(rid, tr);
 	}
 
 	if (node_draw.is_valid()) {
 		node_draw->time += p_delta;
-		node_draw->delta = p_delta;
-		if (node_draw->queued_redraw) {
-			node_draw->node->queue_redraw();
+		node_draw->pending_delta += p_delta;
+		node_draw->rate_phase += p_delta;
+		// Persisted nodes removed from the tree keep their clock but never redraw, the rect projection runs last as the costliest check
+		bool allowed = inside && node->is_inside_tree() && node_draw->is_redraw_allowed();
+		if (allowed && node_draw->cull_offscreen) allowed = !is_offscreen();
+		if (node_draw->threaded) {
+			node_draw->update_generator(allowed);
+		} else if (allowed) {
+			if (node_draw->cache_item.is_valid() || node_draw->batched) {
+				node_draw->record();
+			} else if (node_draw->queued_redraw) {
+				node_draw->node->queue_redraw();
+			}
+		}
+		// Children are updated first, so the owner sees every member when composing below
+		if (node_draw->batched) {
+			draw_batch_owner->draw_batch_members.push_back(node_draw.ptr());
 		}
 	}
 
+	if (draw_batch_item.is_valid()) {
+		draw_batch_update();
+	}
+
 	if (debug_canvas_item.is_valid()) {
 		RenderingServer::get_singleton()->canvas_item_clear(debug_canvas_item);
 
@@ -295,6 +844,7 @@ void UI::draw_update(float p_delta) {
 }
 
 void UI::set_builtin_classes(const Dictionary &p_dict) {
+	// Builtin classes are resolved natively by name, entries here only override them
 	UI::builtin_scripts.clear();
 	Array keys = p_dict.keys();
 	for (int i = 0; i < keys.size(); i++) {
@@ -306,14 +856,27 @@ void UI::set_builtin_classes(const Dictionary &p_dict) {
 	}
 }
 
-Object *UI::get_builtin_class(const String &p_class) {
-	ERR_FAIL_COND_V_MSG(
-		!UI::builtin_scripts.has(p_class),
-		nullptr,
-		vformat("Couldn't get class of type '%s'", p_class)
-	);
+void UI::clear_builtin_classes() {
+	UI::builtin_scripts.clear();
+	UI::builtin_classes.clear();
+}
+
+Variant UI::get_builtin_class(const StringName &p_class) {
+	HashMap<String, Object *>::Iterator script = UI::builtin_scripts.find(p_class);
+	if (script) return script->value;
+
+	return p_class;
+}
+
+bool UI::is_builtin_class(const StringName &p_class) {
+	// Looked up in ClassDB the first time each class is used, then cached
+	HashMap<StringName, bool>::Iterator it = UI::builtin_classes.find(p_class);
+	if (it) return it->value;
 
-	return UI::builtin_scripts.get(p_class);
+	ClassDBSingleton *db = ClassDBSingleton::get_singleton();
+	bool valid = db->class_exists(p_class) && db->can_instantiate(p_class) && (p_class == StringName("Control") || db->is_parent_class(p_class, "Control"));
+	UI::builtin_classes.insert(p_class, valid);
+	return valid;
 }
 
 Ref<UI> UI::add(const Variant &p_type, const Variant &p_key, bool p_persist, const Dictionary &p_props) {
@@ -321,6 +884,8 @@ Ref<UI> UI::add(const Variant &p_type, const Variant &p_key, bool p_persist, con
 
 	bool is_object = p_type.get_type() == Variant::Type::OBJECT;
 	bool is_callable = p_type.get_type() == Variant::Type::CALLABLE;
+	bool is_class = p_type.get_type() == Variant::Type::STRING_NAME || p_type.get_type() == Variant::Type::STRING;
+	StringName type_class = is_class ? (StringName)p_type : StringName();
 	Object *obj = is_object ? p_type : nullptr;
 	PackedScene *type_scene = is_object ? Object::cast_to<PackedScene>(obj) : nullptr;
 	Callable type_callable = is_callable ? (Callable)p_type : Callable();
@@ -328,14 +893,21 @@ Ref<UI> UI::add(const Variant &p_type, const Variant &p_key, bool p_persist, con
 	bool is_script = is_object && obj->has_method("new");
 
 	ERR_FAIL_COND_V_MSG(
-		!(is_callable || is_scene || is_script),
+		!(is_callable || is_class || is_scene || is_script),
 		nullptr,
-		"Type must be a Callable, PackedScene, native class or a script"
+		"Type must be a Callable, PackedScene, class name, native class or a script"
+	);
+	ERR_FAIL_COND_V_MSG(
+		is_class && !is_builtin_class(type_class),
+		nullptr,
+		vformat("Class '%s' must exist, be instantiable and inherit Control", type_class)
 	);
 
 	uint64_t type_key = 0;
 	if (is_callable) {
 		type_key = (uint64_t)type_callable.hash();
+	} else if (is_class) {
+		type_key = (uint64_t)type_class.hash();
 	} else if (is_object) {
 		type_key = obj->get_instance_id();
 	}
@@ -365,8 +937,12 @@ Ref<UI> UI::add(const Variant &p_type, const Variant &p_key, bool p_persist, con
 			Variant ret = type_callable.call();
 			ERR_FAIL_COND_V_MSG(!(ret.get_type() == Variant::Type::OBJECT && Object::cast_to<Node>(ret)), nullptr, "Callable must return a Node");
 			node = Object::cast_to<Node>(ret);
+		} else if (is_class) {
+			node = Object::cast_to<Node>((Object *)ClassDBSingleton::get_singleton()->instantiate(type_class));
 		} else if (is_scene) {
-			node = type_scene->instantiate();
+			// Prewarmed scenes hand out an instance built on a worker thread, instantiating here only when the pool ran dry
+			node = ScenePool::take(type_scene);
+			if (!node) node = type_scene->instantiate();
 		} else {
 			node = Object::cast_to<Node>(obj->call("new"));
 		}
@@ -376,6 +952,14 @@ Ref<UI> UI::add(const Variant &p_type, const Variant &p_key, bool p_persist, con
 
 		ref = type->value.children.insert(index, UI::create_ui_parented(node, this));
 		ref->value->index = index;
+		// Remembered so snapshots can recreate the node, callables and unsaved resources can't be
+		if (is_class) {
+			ref->value->type_kind = UISnapshot::TYPE_CLASS;
+			ref->value->type_name = type_class;
+		} else if (is_object && Object::cast_to<Resource>(obj) && !Object::cast_to<Resource>(obj)->get_path().is_empty()) {
+			ref->value->type_kind = is_scene ? UISnapshot::TYPE_SCENE : UISnapshot::TYPE_SCRIPT;
+			ref->value->type_name = Object::cast_to<Resource>(obj)->get_path();
+		}
 		ref->value->deletion = true;
 		ref->value->inside = false;
 		ref->value->props(p_props);
@@ -386,6 +970,7 @@ Ref<UI> UI::add(const Variant &p_type, const Variant &p_key, bool p_persist, con
 	ref->value->deletion = false;
 	ref->value->persist = p_persist;
 	ref->value->repaint = false;
+	ref->value->reconciling = reconciling;
 
 	if (!ref->value->inside) {
 		node->add_child(ref->value->node);
@@ -407,6 +992,96 @@ Ref<UI> UI::show(const Callable &p_ui_callable) {
 	return this;
 }
 
+Ref<UISnapshot> UI::snapshot() const {
+	Ref<UISnapshot> snapshot;
+	snapshot.instantiate();
+	snapshot->encode(this);
+	return snapshot;
+}
+
+Ref<UI> UI::hydrate(const Ref<UISnapshot> &p_snapshot) {
+	ERR_FAIL_COND_V_MSG(p_snapshot.is_null(), this, "Snapshot is null");
+	for (UITypeCollection::Iterator type = types.begin(); type; ++type) {
+		ERR_FAIL_COND_V_MSG(type->value.children.size() > 0, this, "Can only hydrate a UI without children");
+	}
+
+	// The next update then finds every node by its key and only applies what changed
+	int64_t entry = 0;
+	child_idx = 0;
+	p_snapshot->resources.clear();
+	hydrate_children(p_snapshot, entry, p_snapshot->root_count);
+	child_idx = 0;
+
+	return this;
+}
+
+void UI::hydrate_children(const Ref<UISnapshot> &p_snapshot, int64_t &r_entry, uint32_t p_count) {
+	for (uint32_t i = 0; i < p_count; i++) {
+		ERR_FAIL_COND_MSG(r_entry >= p_snapshot->entries.size(), "UI snapshot entries are out of range");
+		const UISnapshot::Entry &entry = p_snapshot->entries[r_entry++];
+
+		Node *child = nullptr;
+		uint64_t type_key = 0;
+		switch (entry.kind) {
+			case UISnapshot::TYPE_CLASS: {
+				StringName type_class = entry.type_name;
+				if (!is_builtin_class(type_class)) break;
+				child = Object::cast_to<Node>((Object *)ClassDBSingleton::get_singleton()->instantiate(type_class));
+				type_key = (uint64_t)type_class.hash();
+			} break;
+			case UISnapshot::TYPE_SCENE: {
+				Ref<PackedScene> scene = ResourceLoader::get_singleton()->load(entry.type_name);
+				if (scene.is_null()) break;
+				p_snapshot->resources.push_back(scene);
+				child = ScenePool::take(scene);
+				if (!child) child = scene->instantiate();
+				type_key = scene->get_instance_id();
+			} break;
+			case UISnapshot::TYPE_SCRIPT: {
+				Ref<Resource> script = ResourceLoader::get_singleton()->load(entry.type_name);
+				if (script.is_null() || !script->has_method("new")) break;
+				p_snapshot->resources.push_back(script);
+				child = Object::cast_to<Node>(script->call("new"));
+				type_key = script->get_instance_id();
+			} break;
+		}
+
+		if (!child) {
+			ERR_PRINT(vformat("Couldn't hydrate '%s', it's left to the builder", entry.type_name));
+			r_entry += entry.descendants;
+			continue;
+		}
+
+		child->set_name(vformat("%s:%d", child->get_class(), child_idx + 1));
+		Array keys = entry.props.keys();
+		for (int64_t j = 0; j < keys.size(); j++) {
+			child->set(keys[j], entry.props[keys[j]]);
+		}
+
+		UITypeCollection::Iterator type = types.find(type_key);
+		if (!type) {
+			type = types.insert(type_key, UINodeCollection());
+		}
+
+		Ref<UI> ui = UI::create_ui_parented(child, this);
+		ui->index = entry.index;
+		ui->type_kind = entry.kind;
+		ui->type_name = entry.type_name;
+		ui->persist = entry.persist;
+		ui->deletion = false;
+		ui->inside = true;
+		ui->repaint = false;
+		type->value.children.insert(entry.index, ui);
+
+		// The subtree is assembled before it is attached, so it enters the tree in one pass
+		ui->hydrate_children(p_snapshot, r_entry, entry.child_count);
+		ui->child_idx = 0;
+
+		node->add_child(child);
+		child_idx++;
+	}
+}
+
 Ref<UI> UI::prop(const String &p_name, const Variant &p_val) {
 	NodePath name = NodePath(p_name);
 	// if (node->get_indexed(name) != p_val) {
@@ -445,8 +1120,35 @@ Ref<UI> UI::motion(const Callable &p_motion_callable) {
 	return this;
 }
 
+Ref<UI> UI::motion_timeline(const Ref<MotionTimeline> &p_timeline, const Array &p_callbacks) {
+	if (node_motion.is_null()) {
+		node_motion.instantiate();
+		node_motion->node = node;
+		node_motion->clear();
+	}
+	node_motion->timeline(p_timeline, p_callbacks);
+
+	return this;
+}
+
+Ref<UI> UI::motion_shared(const Ref<MotionRef> &p_motion, float p_stagger, float p_value_scale, const Variant &p_value_offset) {
+	ERR_FAIL_COND_V_MSG(p_motion.is_null() || !p_motion->shared, this, "Motion must be created with 'MotionRef.create_shared'");
+
+	if (shared_motion != p_motion) {
+		if (shared_motion.is_valid()) shared_motion->unsubscribe(node);
+		shared_motion = p_motion;
+	}
+
+	// Subscribing again keeps the running clock, so rebuilds don't restart the stagger
+	shared_motion->subscribe(node, p_stagger, p_value_scale, p_value_offset);
+	shared_motion_stale = false;
+
+	return this;
+}
+
 Ref<UI> UI::draw(const Callable &p_canvas_item_callable) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<CanvasItem>(node), this, "Node must inherit CanvasItem");
+	ERR_FAIL_COND_V_MSG(node_draw.is_valid() && (node_draw->cache_item.is_valid() || node_draw->batched), this, "Node is already drawn with 'draw_cached' or 'draw_threaded'");
 
 	if (node_draw.is_null()) {
 		CanvasItem *ci = Object::cast_to<CanvasItem>(node);
@@ -461,24 +1163,115 @@ Ref<UI> UI::draw(const Callable &p_canvas_item_callable) {
 	return this;
 }
 
+Ref<UI> UI::draw_cached(const Callable &p_draw_callable, const Array &p_dependencies) {
+	CanvasItem *ci = Object::cast_to<CanvasItem>(node);
+	ERR_FAIL_COND_V_MSG(!ci, this, "Node must inherit CanvasItem");
+	ERR_FAIL_COND_V_MSG(node_draw.is_valid() && ((!node_draw->cache_item.is_valid() && !node_draw->batched) || node_draw->threaded), this, "Node is already drawn with 'draw' or 'draw_threaded'");
+
+	if (node_draw.is_null()) {
+		node_draw.instantiate();
+		node_draw->node = ci;
+
+		// Under a batching container the geometry goes into the container's canvas item instead
+		draw_batch_owner = parent;
+		while (draw_batch_owner && !draw_batch_owner->draw_batch_item.is_valid()) draw_batch_owner = draw_batch_owner->parent;
+
+		if (draw_batch_owner) {
+			node_draw->batched = true;
+		} else {
+			// Drawn below the node's children, like the node's own drawing
+			RenderingServer *rs = RenderingServer::get_singleton();
+			node_draw->cache_item = rs->canvas_item_create();
+			rs->canvas_item_set_parent(node_draw->cache_item, ci->get_canvas_item());
+			rs->canvas_item_set_draw_index(node_draw->cache_item, -1);
+		}
+		node_draw->queue_redraw();
+	}
+
+	// Rebuilds only record again when a declared dependency changed, the callable is kept fresh for when they do
+	node_draw->draw_callable = p_draw_callable;
+	if (p_dependencies != node_draw->cache_dependencies) {
+		node_draw->cache_dependencies = p_dependencies.duplicate();
+		node_draw->queue_redraw();
+	}
+
+	return this;
+}
+
+Ref<UI> UI::draw_threaded(const Callable &p_generator, bool p_continuous, bool p_double_buffer) {
+	CanvasItem *ci = Object::cast_to<CanvasItem>(node);
+	ERR_FAIL_COND_V_MSG(!ci, this, "Node must inherit CanvasItem");
+	ERR_FAIL_COND_V_MSG(node_draw.is_valid() && !node_draw->threaded, this, "Node is already drawn with 'draw' or 'draw_cached'");
+
+	if (node_draw.is_null()) {
+		RenderingServer *rs = RenderingServer::get_singleton();
+		node_draw.instantiate();
+		node_draw->node = ci;
+		node_draw->threaded = true;
+		node_draw->cache_item = rs->canvas_item_create();
+		rs->canvas_item_set_parent(node_draw->cache_item, ci->get_canvas_item());
+		rs->canvas_item_set_draw_index(node_draw->cache_item, -1);
+		node_draw->queue_redraw();
+	}
+
+	// Called on a worker thread as generator(time, size), must not touch the scene tree
+	node_draw->draw_callable = p_generator;
+	node_draw->generator_continuous = p_continuous;
+	node_draw->generator_double_buffer = p_double_buffer;
+
+	return this;
+}
+
+Ref<UI> UI::draw_batch() {
+	CanvasItem *ci = Object::cast_to<CanvasItem>(node);
+	ERR_FAIL_COND_V_MSG(!ci, this, "Node must inherit CanvasItem");
+
+	// Descendants calling 'draw_cached' afterwards submit into this single canvas item, drawn above the children
+	if (!draw_batch_item.is_valid()) {
+		RenderingServer *rs = RenderingServer::get_singleton();
+		draw_batch_item = rs->canvas_item_create();
+		rs->canvas_item_set_parent(draw_batch_item, ci->get_canvas_item());
+	}
+
+	return this;
+}
+
+Ref<UI> UI::draw_policy(float p_max_rate, bool p_cull_hidden, bool p_cull_offscreen, bool p_pause_unfocused) {
+	ERR_FAIL_COND_V_MSG(node_draw.is_null(), this, "Must call 'draw' or 'draw_cached' first");
+	ERR_FAIL_COND_V_MSG(p_max_rate < 0.0, this, "Max rate must be greater or equal 0.0");
+
+	node_draw->max_rate = p_max_rate;
+	node_draw->cull_hidden = p_cull_hidden;
+	node_draw->cull_offscreen = p_cull_offscreen;
+	node_draw->pause_unfocused = p_pause_unfocused;
+
+	return this;
+}
+
 Ref<UI> UI::event(const String &p_signal_name, const Callable &p_target) {
 	HashMap<String, SignalInfo>::Iterator signal_info = signals.find(p_signal_name);
 	if (!signal_info) {
 		signal_info = signals.insert(p_signal_name, SignalInfo());
 		signal_info->value.target = Callable();
 		signal_info->value.disconnect = true;
+		signal_info->value.connected = false;
 	}
 
 	ERR_FAIL_COND_V_MSG(!signal_info->value.disconnect, this, "Signal already connected");
 
-	if (signal_info->value.target.is_null()) {
-		node->connect(p_signal_name, p_target);
-		signal_info->value.target = p_target;
+	UI *ui_root = root ? root : this;
+	EventKey key;
+	key.id = node->get_instance_id();
+	key.signal = p_signal_name;
+
+	// Each node signal is connected once to the root's forwarder, changing the handler only touches the root table
+	if (!signal_info->value.connected) {
+		node->connect(p_signal_name, Callable(ui_root, "_dispatch_event").bind(key.id, key.signal));
+		signal_info->value.connected = true;
 	}
 
-	if (signal_info->value.target.hash() != p_target.hash()) {
-		node->disconnect(p_signal_name, signal_info->value.target);
-		node->connect(p_signal_name, p_target);
+	if (signal_info->value.target.is_null() || signal_info->value.target.hash() != p_target.hash()) {
+		ui_root->event_handlers.insert(key, p_target);
 		signal_info->value.target = p_target;
 	}
 
@@ -487,6 +1280,43 @@ Ref<UI> UI::event(const String &p_signal_name, const Callable &p_target) {
 	return this;
 }
 
+Ref<UILite> UI::lite(const Dictionary &p_props) {
+	Control *control = Object::cast_to<Control>(node);
+	ERR_FAIL_COND_V_MSG(!control, nullptr, "Node must inherit Control");
+
+	if (lite_cursor.is_null()) {
+		lite_cursor.instantiate();
+		lite_cursor->owner = this;
+		control->connect("gui_input", callable_mp(this, &UI::lite_gui_input));
+		control->connect("mouse_exited", callable_mp(this, &UI::lite_mouse_exited));
+	}
+
+	lite_items.push_back(LiteItem());
+	lite_cursor->item = lite_items.size() - 1;
+	lite_cursor->props(p_props);
+
+	return lite_cursor;
+}
+
+Ref<UI> UI::lite_grid(int p_columns, const Vector2 &p_cell_size, const Vector2 &p_separation) {
+	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
+	ERR_FAIL_COND_V_MSG(p_columns < 1, this, "Columns must be at least 1");
+
+	if (lite_columns != p_columns || lite_cell_size != p_cell_size || lite_separation != p_separation) {
+		lite_columns = p_columns;
+		lite_cell_size = p_cell_size;
+		lite_separation = p_separation;
+		// Force the next commit to relayout even if the items didn't change
+		lite_drawn.clear();
+		lite_cells.clear();
+		lite_explicit.clear();
+		lite_hover = -1;
+		lite_pressed = -1;
+	}
+
+	return this;
+}
+
 Ref<UI> UI::label(const String &p_text, const Variant &p_key, bool p_persist) {
 	
 	Ref<UI> label = this->add(get_builtin_class("Label"), p_key, p_persist);
@@ -498,6 +1328,13 @@ Ref<UI> UI::label(const String &p_text, const Variant &p_key, bool p_persist) {
 	return label;
 }
 
+Ref<UI> UI::text(const String &p_text, const Variant &p_key, bool p_persist) {
+	Ref<UI> text = this->add(get_builtin_class("UIText"), p_key, p_persist);
+	ERR_FAIL_COND_V_MSG(!text.is_valid(), nullptr, "Failed to create a text node");
+	text->prop("text", p_text);
+	return text;
+}
+
 Ref<UI> UI::button(const String &p_text, const Variant &p_key, bool p_persist) {
 	Ref<UI> button = this->add(get_builtin_class("Button"), p_key, p_persist);
 	ERR_FAIL_COND_V_MSG(!button.is_valid(), nullptr, "Failed to create a button node");
@@ -572,6 +1409,35 @@ Ref<UI> UI::animate_rect(float p_speed) {
 	return this;
 }
 
+Ref<UI> UI::set_motion_paused(bool p_paused) {
+	UI *ui_root = root ? root : this;
+	ui_root->motion_paused = p_paused;
+	return this;
+}
+
+Ref<UI> UI::set_motion_time_scale(float p_scale) {
+	ERR_FAIL_COND_V_MSG(p_scale < 0.0, this, "Time scale must be greater or equal 0.0");
+	UI *ui_root = root ? root : this;
+	ui_root->motion_time_scale = p_scale;
+	return this;
+}
+
+Ref<UI> UI::set_motion_fixed_step(float p_step) {
+	ERR_FAIL_COND_V_MSG(p_step < 0.0, this, "Step must be greater or equal 0.0");
+	UI *ui_root = root ? root : this;
+	ui_root->motion_fixed_step = p_step;
+	ui_root->motion_step_accum = 0.0;
+	return this;
+}
+
+Ref<UI> UI::set_motion_lod(bool p_skip_hidden, float p_offscreen_rate) {
+	ERR_FAIL_COND_V_MSG(p_offscreen_rate < 0.0, this, "Off-screen rate must be greater or equal 0.0");
+	UI *ui_root = root ? root : this;
+	ui_root->motion_skip_hidden = p_skip_hidden;
+	ui_root->motion_offscreen_rate = p_offscreen_rate;
+	return this;
+}
+
 Ref<UI> UI::theme_variation(const String &p_theme_type) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	Control *control = Object::cast_to<Control>(node);
@@ -586,14 +1452,42 @@ Ref<UI> UI::axis_size_flags(bool p_vertical, BitField<Control::SizeFlags> p_flag
 	Control *control = Object::cast_to<Control>(node);
 
 	if (p_vertical) {
-		control->set_v_size_flags(p_flags);
+		layout_v_flags = p_flags;
+		layout_pending |= LAYOUT_V_FLAGS;
 	} else {
-		control->set_h_size_flags(p_flags);
+		layout_h_flags = p_flags;
+		layout_pending |= LAYOUT_H_FLAGS;
 	}
 
+	if (!reconciling) apply_layout(control);
+
 	return this;
 }
 
+void UI::queue_anchor_and_offset(Side p_side, float p_anchor, float p_offset) {
+	layout_anchors[p_side] = p_anchor;
+	layout_offsets[p_side] = p_offset;
+	layout_pending |= 1 << p_side;
+
+	if (!reconciling) apply_layout(Object::cast_to<Control>(node));
+}
+
+void UI::apply_layout(Control *p_control) {
+	if (!layout_pending) return;
+
+	// Only the last value the builder wrote for each side and axis reaches the control
+	for (int side = 0; side < 4; side++) {
+		if (!(layout_pending & (1 << side))) continue;
+		// 'set_anchor' has no early out and always resizes, unchanged sides are skipped here
+		if (p_control->get_anchor((Side)side) == layout_anchors[side] && p_control->get_offset((Side)side) == layout_offsets[side]) continue;
+		p_control->set_anchor_and_offset((Side)side, layout_anchors[side], layout_offsets[side]);
+	}
+	if (layout_pending & LAYOUT_H_FLAGS) p_control->set_h_size_flags(layout_h_flags);
+	if (layout_pending & LAYOUT_V_FLAGS) p_control->set_v_size_flags(layout_v_flags);
+
+	layout_pending = 0;
+}
+
 Ref<UI> UI::shrink_begin() {
 	return axis_size_flags(false, Control::SIZE_SHRINK_BEGIN)->axis_size_flags(true, Control::SIZE_SHRINK_BEGIN);
 }
@@ -668,12 +1562,11 @@ Ref<UI> UI::vertical_shrink_end() {
 
 Ref<UI> UI::full_rect() {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
-	Control *control = Object::cast_to<Control>(node);
 
-	control->set_anchor_and_offset(SIDE_LEFT, 0.0, 0.0);
-	control->set_anchor_and_offset(SIDE_TOP, 0.0, 0.0);
-	control->set_anchor_and_offset(SIDE_RIGHT, 1.0, 0.0);
-	control->set_anchor_and_offset(SIDE_BOTTOM, 1.0, 0.0);
+	queue_anchor_and_offset(SIDE_LEFT, 0.0, 0.0);
+	queue_anchor_and_offset(SIDE_TOP, 0.0, 0.0);
+	queue_anchor_and_offset(SIDE_RIGHT, 1.0, 0.0);
+	queue_anchor_and_offset(SIDE_BOTTOM, 1.0, 0.0);
 
 	return this;
 }
@@ -681,7 +1574,6 @@ Ref<UI> UI::full_rect() {
 Ref<UI> UI::margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	ERR_FAIL_COND_V_MSG(p_unit.get_type() != Variant::INT && p_unit.get_type() != Variant::FLOAT && p_unit.get_type() != Variant::STRING, this, "Unit must a number or string");
-	Control *control = Object::cast_to<Control>(node);
 	Variant::Type unit_type = p_unit.get_type();
 
 	Unit unit = unit_type == Variant::STRING ? Unit(((String)p_unit).ptr()) : Unit((float)p_unit);
@@ -689,15 +1581,15 @@ Ref<UI> UI::margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(unit.type == 0, this, "Invalid unit format");
 
 	if (unit.type == Unit::PIXELS) {
-		control->set_anchor_and_offset(SIDE_LEFT, 0.0, unit.value);
-		control->set_anchor_and_offset(SIDE_TOP, 0.0, unit.value);
-		control->set_anchor_and_offset(SIDE_RIGHT, 1.0, -unit.value);
-		control->set_anchor_and_offset(SIDE_BOTTOM, 1.0, -unit.value);
+		queue_anchor_and_offset(SIDE_LEFT, 0.0, unit.value);
+		queue_anchor_and_offset(SIDE_TOP, 0.0, unit.value);
+		queue_anchor_and_offset(SIDE_RIGHT, 1.0, -unit.value);
+		queue_anchor_and_offset(SIDE_BOTTOM, 1.0, -unit.value);
 	} else {
-		control->set_anchor_and_offset(SIDE_LEFT, unit.value, 0.0);
-		control->set_anchor_and_offset(SIDE_TOP, unit.value, 0.0);
-		control->set_anchor_and_offset(SIDE_RIGHT, 1.0 - unit.value, 0.0);
-		control->set_anchor_and_offset(SIDE_BOTTOM, 1.0 - unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_LEFT, unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_TOP, unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_RIGHT, 1.0 - unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_BOTTOM, 1.0 - unit.value, 0.0);
 	}
 
 	return this;
@@ -706,7 +1598,6 @@ Ref<UI> UI::margin(Variant p_unit) {
 Ref<UI> UI::horizontal_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	ERR_FAIL_COND_V_MSG(p_unit.get_type() != Variant::INT && p_unit.get_type() != Variant::FLOAT && p_unit.get_type() != Variant::STRING, this, "Unit must a number or string");
-	Control *control = Object::cast_to<Control>(node);
 	Variant::Type unit_type = p_unit.get_type();
 
 	Unit unit = unit_type == Variant::STRING ? Unit(((String)p_unit).ptr()) : Unit((float)p_unit);
@@ -714,11 +1605,11 @@ Ref<UI> UI::horizontal_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(unit.type == 0, this, "Invalid unit format");
 
 	if (unit.type == Unit::PIXELS) {
-		control->set_anchor_and_offset(SIDE_LEFT, 0.0, unit.value);
-		control->set_anchor_and_offset(SIDE_RIGHT, 1.0, -unit.value);
+		queue_anchor_and_offset(SIDE_LEFT, 0.0, unit.value);
+		queue_anchor_and_offset(SIDE_RIGHT, 1.0, -unit.value);
 	} else {
-		control->set_anchor_and_offset(SIDE_LEFT, unit.value, 0.0);
-		control->set_anchor_and_offset(SIDE_RIGHT, 1.0 - unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_LEFT, unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_RIGHT, 1.0 - unit.value, 0.0);
 	}
 
 	return this;
@@ -727,7 +1618,6 @@ Ref<UI> UI::horizontal_margin(Variant p_unit) {
 Ref<UI> UI::vertical_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	ERR_FAIL_COND_V_MSG(p_unit.get_type() != Variant::INT && p_unit.get_type() != Variant::FLOAT && p_unit.get_type() != Variant::STRING, this, "Unit must a number or string");
-	Control *control = Object::cast_to<Control>(node);
 	Variant::Type unit_type = p_unit.get_type();
 
 	Unit unit = unit_type == Variant::STRING ? Unit(((String)p_unit).ptr()) : Unit((float)p_unit);
@@ -735,11 +1625,11 @@ Ref<UI> UI::vertical_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(unit.type == 0, this, "Invalid unit format");
 
 	if (unit.type == Unit::PIXELS) {
-		control->set_anchor_and_offset(SIDE_TOP, 0.0, unit.value);
-		control->set_anchor_and_offset(SIDE_BOTTOM, 1.0, -unit.value);
+		queue_anchor_and_offset(SIDE_TOP, 0.0, unit.value);
+		queue_anchor_and_offset(SIDE_BOTTOM, 1.0, -unit.value);
 	} else {
-		control->set_anchor_and_offset(SIDE_TOP, unit.value, 0.0);
-		control->set_anchor_and_offset(SIDE_BOTTOM, 1.0 - unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_TOP, unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_BOTTOM, 1.0 - unit.value, 0.0);
 	}
 
 	return this;
@@ -748,7 +1638,6 @@ Ref<UI> UI::vertical_margin(Variant p_unit) {
 Ref<UI> UI::left_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	ERR_FAIL_COND_V_MSG(p_unit.get_type() != Variant::INT && p_unit.get_type() != Variant::FLOAT && p_unit.get_type() != Variant::STRING, this, "Unit must a number or string");
-	Control *control = Object::cast_to<Control>(node);
 	Variant::Type unit_type = p_unit.get_type();
 
 	Unit unit = unit_type == Variant::STRING ? Unit(((String)p_unit).ptr()) : Unit((float)p_unit);
@@ -756,9 +1645,9 @@ Ref<UI> UI::left_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(unit.type == 0, this, "Invalid unit format");
 
 	if (unit.type == Unit::PIXELS) {
-		control->set_anchor_and_offset(SIDE_LEFT, 0.0, unit.value);
+		queue_anchor_and_offset(SIDE_LEFT, 0.0, unit.value);
 	} else {
-		control->set_anchor_and_offset(SIDE_LEFT, unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_LEFT, unit.value, 0.0);
 	}
 
 	return this;
@@ -767,7 +1656,6 @@ Ref<UI> UI::left_margin(Variant p_unit) {
 Ref<UI> UI::top_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	ERR_FAIL_COND_V_MSG(p_unit.get_type() != Variant::INT && p_unit.get_type() != Variant::FLOAT && p_unit.get_type() != Variant::STRING, this, "Unit must a number or string");
-	Control *control = Object::cast_to<Control>(node);
 	Variant::Type unit_type = p_unit.get_type();
 
 	Unit unit = unit_type == Variant::STRING ? Unit(((String)p_unit).ptr()) : Unit((float)p_unit);
@@ -775,9 +1663,9 @@ Ref<UI> UI::top_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(unit.type == 0, this, "Invalid unit format");
 
 	if (unit.type == Unit::PIXELS) {
-		control->set_anchor_and_offset(SIDE_TOP, 0.0, unit.value);
+		queue_anchor_and_offset(SIDE_TOP, 0.0, unit.value);
 	} else {
-		control->set_anchor_and_offset(SIDE_TOP, unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_TOP, unit.value, 0.0);
 	}
 
 	return this;
@@ -786,7 +1674,6 @@ Ref<UI> UI::top_margin(Variant p_unit) {
 Ref<UI> UI::right_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	ERR_FAIL_COND_V_MSG(p_unit.get_type() != Variant::INT && p_unit.get_type() != Variant::FLOAT && p_unit.get_type() != Variant::STRING, this, "Unit must a number or string");
-	Control *control = Object::cast_to<Control>(node);
 	Variant::Type unit_type = p_unit.get_type();
 
 	Unit unit = unit_type == Variant::STRING ? Unit(((String)p_unit).ptr()) : Unit((float)p_unit);
@@ -794,9 +1681,9 @@ Ref<UI> UI::right_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(unit.type == 0, this, "Invalid unit format");
 
 	if (unit.type == Unit::PIXELS) {
-		control->set_anchor_and_offset(SIDE_RIGHT, 0.0, -unit.value);
+		queue_anchor_and_offset(SIDE_RIGHT, 0.0, -unit.value);
 	} else {
-		control->set_anchor_and_offset(SIDE_RIGHT, 1.0 - unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_RIGHT, 1.0 - unit.value, 0.0);
 	}
 
 	return this;
@@ -805,7 +1692,6 @@ Ref<UI> UI::right_margin(Variant p_unit) {
 Ref<UI> UI::bottom_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(!Object::cast_to<Control>(node), this, "Node must inherit Control");
 	ERR_FAIL_COND_V_MSG(p_unit.get_type() != Variant::INT && p_unit.get_type() != Variant::FLOAT && p_unit.get_type() != Variant::STRING, this, "Unit must a number or string");
-	Control *control = Object::cast_to<Control>(node);
 	Variant::Type unit_type = p_unit.get_type();
 
 	Unit unit = unit_type == Variant::STRING ? Unit(((String)p_unit).ptr()) : Unit((float)p_unit);
@@ -813,9 +1699,9 @@ Ref<UI> UI::bottom_margin(Variant p_unit) {
 	ERR_FAIL_COND_V_MSG(unit.type == 0, this, "Invalid unit format");
 
 	if (unit.type == Unit::PIXELS) {
-		control->set_anchor_and_offset(SIDE_BOTTOM, 0.0, -unit.value);
+		queue_anchor_and_offset(SIDE_BOTTOM, 0.0, -unit.value);
 	} else {
-		control->set_anchor_and_offset(SIDE_BOTTOM, 1.0 - unit.value, 0.0);
+		queue_anchor_and_offset(SIDE_BOTTOM, 1.0 - unit.value, 0.0);
 	}
 
 	return this;
@@ -849,6 +1735,14 @@ Ref<UI> UI::create_ui(Node *p_node) {
 void UI::_bind_methods() {
 	ClassDB::bind_static_method("UI", D_METHOD("create", "node"), &UI::create_ui);
 	ClassDB::bind_static_method("UI", D_METHOD("set_builtin_classes", "classes_dict"), &UI::set_builtin_classes);
+	ClassDB::bind_static_method("UI", D_METHOD("set_motion_threads", "enabled"), &UI::set_motion_threads);
+	ClassDB::bind_static_method("UI", D_METHOD("set_text_cache_size", "size"), &UI::set_text_cache_size);
+	ClassDB::bind_static_method("UI", D_METHOD("set_tracing", "enabled", "capacity"), &UI::set_tracing, DEFVAL(65536));
+	ClassDB::bind_static_method("UI", D_METHOD("dump_trace", "path"), &UI::dump_trace);
+	ClassDB::bind_static_method("UI", D_METHOD("prewarm_scene", "scene", "count"), &UI::prewarm_scene);
+	ClassDB::bind_static_method("UI", D_METHOD("get_scene_pool_stats"), &UI::get_scene_pool_stats);
+	ClassDB::bind_static_method("UI", D_METHOD("clear_scene_pools"), &UI::clear_scene_pools);
+	ClassDB::bind_static_method("UI", D_METHOD("clear_trace"), &UI::clear_trace);
 
 	ClassDB::bind_method(D_METHOD("clear_children"), &UI::clear_children);
 	ClassDB::bind_method(D_METHOD("set_debug", "enabled"), &UI::set_debug);
@@ -859,10 +1753,22 @@ void UI::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("method", "method_name", "args"), &UI::method, DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("method_ret", "method_name", "args"), &UI::method_ret, DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("motion", "motion_callable"), &UI::motion);
+	ClassDB::bind_method(D_METHOD("motion_timeline", "timeline", "callbacks"), &UI::motion_timeline, DEFVAL(Array()));
+	ClassDB::bind_method(D_METHOD("motion_shared", "motion", "stagger", "value_scale", "value_offset"), &UI::motion_shared, DEFVAL(0.0), DEFVAL(1.0), DEFVAL(Variant()));
 	ClassDB::bind_method(D_METHOD("draw", "draw_callable"), &UI::draw);
+	ClassDB::bind_method(D_METHOD("draw_cached", "draw_callable", "dependencies"), &UI::draw_cached, DEFVAL(Array()));
+	ClassDB::bind_method(D_METHOD("draw_threaded", "generator", "continuous", "double_buffer"), &UI::draw_threaded, DEFVAL(false), DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("draw_batch"), &UI::draw_batch);
+	ClassDB::bind_method(D_METHOD("draw_policy", "max_rate", "cull_hidden", "cull_offscreen", "pause_unfocused"), &UI::draw_policy, DEFVAL(0.0), DEFVAL(true), DEFVAL(true), DEFVAL(true));
 	ClassDB::bind_method(D_METHOD("event", "signal_name", "target"), &UI::event);
 	
+	ClassDB::bind_vararg_method(METHOD_FLAGS_DEFAULT, "_dispatch_event", &UI::dispatch_event, MethodInfo("_dispatch_event"));
+	ClassDB::bind_method(D_METHOD("snapshot"), &UI::snapshot);
+	ClassDB::bind_method(D_METHOD("hydrate", "snapshot"), &UI::hydrate);
+	ClassDB::bind_method(D_METHOD("lite", "props"), &UI::lite, DEFVAL(Dictionary()));
+	ClassDB::bind_method(D_METHOD("lite_grid", "columns", "cell_size", "separation"), &UI::lite_grid, DEFVAL(Vector2()));
 	ClassDB::bind_method(D_METHOD("label", "text", "key", "persist"), &UI::label, DEFVAL(Variant()), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("text", "text", "key", "persist"), &UI::text, DEFVAL(Variant()), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("button", "text", "key", "persist"), &UI::button, DEFVAL(Variant()), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("line_edit", "text", "key", "persist"), &UI::line_edit, DEFVAL(Variant()), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("hbox", "key", "persist"), &UI::hbox, DEFVAL(Variant()), DEFVAL(false));
@@ -877,6 +1783,11 @@ void UI::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("animate_rect", "speed"), &UI::animate_rect, DEFVAL(10.0));
 
+	ClassDB::bind_method(D_METHOD("set_motion_paused", "paused"), &UI::set_motion_paused);
+	ClassDB::bind_method(D_METHOD("set_motion_time_scale", "scale"), &UI::set_motion_time_scale);
+	ClassDB::bind_method(D_METHOD("set_motion_fixed_step", "step"), &UI::set_motion_fixed_step);
+	ClassDB::bind_method(D_METHOD("set_motion_lod", "skip_hidden", "offscreen_rate"), &UI::set_motion_lod, DEFVAL(0.0));
+
 	ClassDB::bind_method(D_METHOD("theme_variation", "theme_type"), &UI::theme_variation);
 	
 	ClassDB::bind_method(D_METHOD("shrink_begin"), &UI::shrink_begin);
@@ -916,18 +1827,57 @@ UI::UI() {
 	index = "";
 	node = nullptr;
 	signals = HashMap<String, SignalInfo>();
+	event_handlers = HashMap<EventKey, Callable, EventKey>();
 	deletion = false;
 	inside = false;
 	repaint = true;
 	types = UITypeCollection();
 	child_idx = 0;
+	type_kind = UISnapshot::TYPE_CALLABLE;
+	type_name = String();
+	reconciling = false;
+	layout_pending = 0;
+	layout_h_flags = 0;
+	layout_v_flags = 0;
+	for (int side = 0; side < 4; side++) {
+		layout_anchors[side] = 0.0;
+		layout_offsets[side] = 0.0;
+	}
 
 	update_callable = Callable();
 
 	rect_current = Rect2();
 	rect_animation_speed = 0.0;
 	node_motion = Ref<MotionRef>();
+	shared_motion = Ref<MotionRef>();
+	shared_motion_stale = false;
 	node_draw = Ref<DrawRef>();
+	draw_batch_owner = nullptr;
+	draw_batch_item = RID();
+	draw_batch_members = LocalVector<DrawRef *>();
+	draw_batch_count = 0;
+
+	motion_clock = 0.0;
+	motion_time_scale = 1.0;
+	motion_fixed_step = 0.0;
+	motion_step_accum = 0.0;
+	motion_offscreen_rate = 0.0;
+	motion_paused = false;
+	motion_skip_hidden = false;
+
+	lite_items = LocalVector<LiteItem>();
+	lite_drawn = LocalVector<LiteItem>();
+	lite_events = HashMap<uint64_t, Callable>();
+	lite_cursor = Ref<UILite>();
+	lite_canvas_item = RID();
+	lite_hover_item = RID();
+	lite_cell_size = Vector2(64.0, 24.0);
+	lite_separation = Vector2();
+	lite_columns = 1;
+	lite_hover = -1;
+	lite_pressed = -1;
+	lite_cells = LocalVector<uint32_t>();
+	lite_explicit = LocalVector<uint32_t>();
 
 	debug_canvas_item = RID();
 	debug_prev_update_elapsed = 1.0;
@@ -941,6 +1891,10 @@ UI::UI() {
 }
 
 UI::~UI() {
+	if (shared_motion.is_valid() && node) {
+		shared_motion->unsubscribe(node);
+	}
+
 	node = nullptr;
 
 	for (UITypeCollection::Iterator type = types.begin(); type; ++type) {
@@ -956,4 +1910,16 @@ UI::~UI() {
 
 	if (debug_canvas_item.is_valid())
 		RenderingServer::get_singleton()->free_rid(debug_canvas_item);
+
+	if (draw_batch_item.is_valid())
+		RenderingServer::get_singleton()->free_rid(draw_batch_item);
+
+	if (lite_cursor.is_valid())
+		lite_cursor->owner = nullptr;
+
+	if (lite_hover_item.is_valid())
+		RenderingServer::get_singleton()->free_rid(lite_hover_item);
+
+	if (lite_canvas_item.is_valid())
+		RenderingServer::get_singleton()->free_rid(lite_canvas_item);
 }
\ No newline at end of file
@@ -2,13 +2,20 @@
 #define GODUI_UI_H
 
 #include "motion_ref.h"
+#include "motion_timeline.h"
 #include "draw_ref.h"
+#include "ui_lite.h"
+#include "ui_snapshot.h"
 
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/classes/node.hpp>
 #include <godot_cpp/classes/control.hpp>
 #include <godot_cpp/classes/font.hpp>
+#include <godot_cpp/classes/input_event.hpp>
+#include <godot_cpp/classes/packed_scene.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hashfuncs.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 #include <godot_cpp/variant/callable.hpp>
 
 namespace godot {
@@ -16,9 +23,71 @@ namespace godot {
 class UI : public RefCounted {
 	GDCLASS(UI, RefCounted);
 
+	friend class UILite;
+	friend class UISnapshot;
+	friend class Trace;
+
+	enum {
+		LITE_HAS_RECT = 1,
+		LITE_HAS_HOVER = 2,
+		LITE_HAS_FONT_COLOR = 4,
+	};
+
+	enum {
+		LITE_EVENT_PRESSED,
+		LITE_EVENT_MOUSE_ENTERED,
+		LITE_EVENT_MOUSE_EXITED,
+	};
+
+	// Leaf widget without a node, laid out and drawn by the UI that owns it
+	struct LiteItem {
+		Rect2 rect;
+		Color color;
+		Color hover_color;
+		Color font_color;
+		String text;
+		uint8_t flags;
+		// Grid cell, numbered over the items without an explicit rect, set on commit
+		uint32_t cell;
+
+		inline bool operator==(const LiteItem &p_other) const {
+			return flags == p_other.flags && rect == p_other.rect && color == p_other.color &&
+				hover_color == p_other.hover_color && font_color == p_other.font_color && text == p_other.text;
+		}
+
+		inline LiteItem() {
+			rect = Rect2();
+			color = Color(0.0, 0.0, 0.0, 0.0);
+			hover_color = Color(0.0, 0.0, 0.0, 0.0);
+			font_color = Color();
+			text = String();
+			flags = 0;
+			cell = 0;
+		}
+	};
+
 	struct SignalInfo {
 		Callable target;
 		bool disconnect;
+		bool connected;
+	};
+
+	struct EventKey {
+		uint64_t id;
+		StringName signal;
+
+		static inline uint32_t hash(const EventKey &p_key) {
+			return hash_fmix32(hash_murmur3_one_64(p_key.id, p_key.signal.hash()));
+		}
+
+		inline bool operator==(const EventKey &p_other) const {
+			return id == p_other.id && signal == p_other.signal;
+		}
+
+		inline EventKey() {
+			id = 0;
+			signal = StringName();
+		}
 	};
 
 	struct UINodeCollection {
@@ -32,6 +101,8 @@ class UI : public RefCounted {
 	};
 
 	static HashMap<String, Object *> builtin_scripts;
+	static HashMap<StringName, bool> builtin_classes;
+	static bool motion_threads;
 
 	using UITypeCollection = HashMap<uint64_t, UINodeCollection>;
 	using UIChildrenCollection = HashMap<String, Ref<UI>>;
@@ -41,19 +112,67 @@ class UI : public RefCounted {
 	String index;
 	Node *node;
 	HashMap<String, SignalInfo> signals;
+	HashMap<EventKey, Callable, EventKey> event_handlers;
 	bool persist;
 	bool deletion;
 	bool inside;
 	bool repaint;
 	UITypeCollection types;
 	uint64_t child_idx;
+	uint8_t type_kind;
+	String type_name;
+
+	enum {
+		LAYOUT_H_FLAGS = 16,
+		LAYOUT_V_FLAGS = 32,
+	};
+
+	// Anchors, offsets and size flags written by the builder, applied once in post_update
+	bool reconciling;
+	uint8_t layout_pending;
+	int64_t layout_h_flags;
+	int64_t layout_v_flags;
+	float layout_anchors[4];
+	float layout_offsets[4];
 
 	Callable update_callable;
 
 	Rect2 rect_current;
 	float rect_animation_speed;
 	Ref<MotionRef> node_motion;
+	Ref<MotionRef> shared_motion;
+	bool shared_motion_stale;
 	Ref<DrawRef> node_draw;
+	UI *draw_batch_owner;
+	RID draw_batch_item;
+	LocalVector<DrawRef *> draw_batch_members;
+	uint32_t draw_batch_count;
+	// Referenced, a callback fired by 'apply' may rebuild the tree and release motions later in the batch
+	LocalVector<Ref<MotionRef>> motion_batch;
+	LocalVector<Ref<MotionRef>> shared_motion_batch;
+
+	LocalVector<LiteItem> lite_items;
+	LocalVector<LiteItem> lite_drawn;
+	HashMap<uint64_t, Callable> lite_events;
+	Ref<UILite> lite_cursor;
+	RID lite_canvas_item;
+	RID lite_hover_item;
+	Vector2 lite_cell_size;
+	Vector2 lite_separation;
+	int32_t lite_columns;
+	int64_t lite_hover;
+	int64_t lite_pressed;
+	// Item index of each grid cell, items with an explicit rect are listed apart in draw order
+	LocalVector<uint32_t> lite_cells;
+	LocalVector<uint32_t> lite_explicit;
+
+	double motion_clock;
+	float motion_time_scale;
+	float motion_fixed_step;
+	float motion_step_accum;
+	float motion_offscreen_rate;
+	bool motion_paused;
+	bool motion_skip_hidden;
 
 	RID debug_canvas_item;
 	Ref<Font> debug_font;
@@ -73,11 +192,36 @@ protected:
 	
 	void remove();
 	void del();
+	void clear_events();
+	Variant dispatch_event(const Variant **p_args, GDExtensionInt p_argc, GDExtensionCallError &r_error);
 	void idle_update(float p_delta);
+	void collect_motions(float p_delta, LocalVector<Ref<MotionRef>> &r_motions);
+	bool step_motion_clock(double &r_clock, bool &r_resync, float p_delta, float &r_step);
+	void evaluate_motions(uint32_t p_chunk);
 	void draw_update(float p_delta);
+	void hydrate_children(const Ref<UISnapshot> &p_snapshot, int64_t &r_entry, uint32_t p_count);
+	void draw_batch_update();
+	Transform2D animate_rect_transform(float p_delta);
+
+	void lite_commit();
+	void lite_update();
+	void lite_hover_update();
+	void lite_draw_item(const RID &p_canvas_item, const LiteItem &p_item, const Rect2 &p_rect, const Color &p_color, const Ref<Font> &p_font, int32_t p_font_size, const Color &p_font_color);
+	void lite_emit(int64_t p_item, uint64_t p_event);
+	void lite_gui_input(const Ref<InputEvent> &p_event);
+	void lite_mouse_exited();
+	Rect2 lite_item_rect(uint32_t p_item) const;
+	int64_t lite_hit(const Vector2 &p_position) const;
 
 	void initialize_builtin_classes();
-	Object *get_builtin_class(const String &p_class);
+	Variant get_builtin_class(const StringName &p_class);
+	static bool is_builtin_class(const StringName &p_class);
+
+	bool is_offscreen() const;
+	String trace_label() const;
+
+	void queue_anchor_and_offset(Side p_side, float p_anchor, float p_offset);
+	void apply_layout(Control *p_control);
 
 	bool extract_anchor_unit(const char *p_unit, float &p_anchor_pos, float &p_anchor_off);
 
@@ -89,16 +233,27 @@ public:
 
 	Ref<UI> add(const Variant &p_type, const Variant &p_key = Variant(), bool p_persist = false, const Dictionary &p_props = Dictionary());
 	Ref<UI> show(const Callable &p_ui_callable);
+	Ref<UISnapshot> snapshot() const;
+	Ref<UI> hydrate(const Ref<UISnapshot> &p_snapshot);
 
 	Ref<UI> prop(const String &p_name, const Variant &p_val);
 	Ref<UI> props(const Dictionary &p_props);
 	Ref<UI> method(const StringName &p_method_name, const Array &p_args);
 	Variant method_ret(const StringName &p_method_name, const Array &p_args);
 	Ref<UI> motion(const Callable &p_motion_callable);
+	Ref<UI> motion_timeline(const Ref<MotionTimeline> &p_timeline, const Array &p_callbacks = Array());
+	Ref<UI> motion_shared(const Ref<MotionRef> &p_motion, float p_stagger = 0.0, float p_value_scale = 1.0, const Variant &p_value_offset = Variant());
 	Ref<UI> draw(const Callable &p_canvas_item_callable);
+	Ref<UI> draw_cached(const Callable &p_draw_callable, const Array &p_dependencies = Array());
+	Ref<UI> draw_threaded(const Callable &p_generator, bool p_continuous = false, bool p_double_buffer = true);
+	Ref<UI> draw_batch();
+	Ref<UI> draw_policy(float p_max_rate = 0.0, bool p_cull_hidden = true, bool p_cull_offscreen = true, bool p_pause_unfocused = true);
 	Ref<UI> event(const String &p_signal_name, const Callable &p_target);
+	Ref<UILite> lite(const Dictionary &p_props = Dictionary());
+	Ref<UI> lite_grid(int p_columns, const Vector2 &p_cell_size, const Vector2 &p_separation = Vector2());
 
 	Ref<UI> label(const String &p_text, const Variant &p_key = Variant(), bool p_persist = false);
+	Ref<UI> text(const String &p_text, const Variant &p_key = Variant(), bool p_persist = false);
 	Ref<UI> button(const String &p_text, const Variant &p_key = Variant(), bool p_persist = false);
 	Ref<UI> line_edit(const String &p_input_text, const Variant &p_key = Variant(), bool p_persist = false);
 	Ref<UI> hbox(const Variant &p_key = Variant(), bool p_persist = false);
@@ -113,6 +268,11 @@ public:
 
 	Ref<UI> animate_rect(float p_speed = 10.0);
 
+	Ref<UI> set_motion_paused(bool p_paused);
+	Ref<UI> set_motion_time_scale(float p_scale);
+	Ref<UI> set_motion_fixed_step(float p_step);
+	Ref<UI> set_motion_lod(bool p_skip_hidden, float p_offscreen_rate = 0.0);
+
 	Ref<UI> theme_variation(const String &p_theme_type);
 
 	Ref<UI> axis_size_flags(bool p_vertical, BitField<Control::SizeFlags> p_flags);
@@ -148,6 +308,15 @@ public:
 	Ref<UI> bottom_margin(Variant unit);
 
 	static void set_builtin_classes(const Dictionary &p_dict);
+	static void clear_builtin_classes();
+	static void set_motion_threads(bool p_enabled);
+	static void set_text_cache_size(int p_size);
+	static void set_tracing(bool p_enabled, int p_capacity = 65536);
+	static void prewarm_scene(const Ref<PackedScene> &p_scene, int p_count);
+	static Dictionary get_scene_pool_stats();
+	static void clear_scene_pools();
+	static Error dump_trace(const String &p_path);
+	static void clear_trace();
 
 	static Ref<UI> create_ui_parented(Node *p_node, const Ref<UI> &p_parent_ui);
 	static Ref<UI> create_ui(Node *p_node);
@@ -0,0 +1,68 @@
+#include "ui_lite.h"
+#include "ui.h"
+
+using namespace godot;
+
+Ref<UILite> UILite::prop(const String &p_name, const Variant &p_val) {
+	ERR_FAIL_COND_V_MSG(!owner || item >= owner->lite_items.size(), this, "Lite item is no longer being built");
+	UI::LiteItem &it = owner->lite_items[item];
+
+	if (p_name == "rect") {
+		it.rect = p_val;
+		it.flags |= UI::LITE_HAS_RECT;
+	} else if (p_name == "color") {
+		it.color = p_val;
+	} else if (p_name == "hover_color") {
+		it.hover_color = p_val;
+		it.flags |= UI::LITE_HAS_HOVER;
+	} else if (p_name == "font_color") {
+		it.font_color = p_val;
+		it.flags |= UI::LITE_HAS_FONT_COLOR;
+	} else if (p_name == "text") {
+		it.text = p_val;
+	} else {
+		ERR_FAIL_V_MSG(this, vformat("Lite items have no property '%s'", p_name));
+	}
+
+	return this;
+}
+
+Ref<UILite> UILite::props(const Dictionary &p_props) {
+	Array keys = p_props.keys();
+	for (int64_t i = keys.size() - 1; i >= 0; i--) {
+		prop(keys[i], p_props[keys[i]]);
+	}
+
+	return this;
+}
+
+Ref<UILite> UILite::event(const String &p_event_name, const Callable &p_target) {
+	ERR_FAIL_COND_V_MSG(!owner || item >= owner->lite_items.size(), this, "Lite item is no longer being built");
+
+	uint64_t event;
+	if (p_event_name == "pressed") {
+		event = UI::LITE_EVENT_PRESSED;
+	} else if (p_event_name == "mouse_entered") {
+		event = UI::LITE_EVENT_MOUSE_ENTERED;
+	} else if (p_event_name == "mouse_exited") {
+		event = UI::LITE_EVENT_MOUSE_EXITED;
+	} else {
+		ERR_FAIL_V_MSG(this, vformat("Lite items have no event '%s'", p_event_name));
+	}
+
+	owner->lite_events.insert(((uint64_t)item << 2) | event, p_target);
+
+	return this;
+}
+
+void UILite::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("prop", "name", "value"), &UILite::prop);
+	ClassDB::bind_method(D_METHOD("props", "props"), &UILite::props);
+	ClassDB::bind_method(D_METHOD("event", "event_name", "target"), &UILite::event);
+	ClassDB::bind_method(D_METHOD("get_index"), &UILite::get_index);
+}
+
+UILite::UILite() {
+	owner = nullptr;
+	item = 0;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef GODUI_UI_LITE_H
+#define GODUI_UI_LITE_H
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/callable.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+namespace godot {
+
+class UI;
+
+// Cursor over the nodeless items of a UI, the same one is reused for every item so building them allocates no objects
+class UILite : public RefCounted {
+	GDCLASS(UILite, RefCounted);
+
+	friend class UI;
+
+	UI *owner;
+	uint32_t item;
+
+protected:
+	static void _bind_methods();
+
+public:
+	Ref<UILite> prop(const String &p_name, const Variant &p_val);
+	Ref<UILite> props(const Dictionary &p_props);
+	Ref<UILite> event(const String &p_event_name, const Callable &p_target);
+
+	inline int get_index() const { return item; }
+
+	UILite();
+};
+
+}
+
+#endif // GODUI_UI_LITE_H
\ No newline at end of file
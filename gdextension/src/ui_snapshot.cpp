@@ -0,0 +1,162 @@
+#include "ui_snapshot.h"
+#include "ui.h"
+#include <godot_cpp/classes/class_db_singleton.hpp>
+#include <godot_cpp/classes/stream_peer_buffer.hpp>
+
+using namespace godot;
+
+// Deeper trees than this are rejected as corrupt instead of recursing forever
+#define UI_SNAPSHOT_MAX_DEPTH 256
+
+// Layout (little endian):
+//   u32 magic, u16 version
+//   u32 child count, per child in node order:
+//     u8 type kind, utf8 class name or resource path, utf8 key, u8 persist
+//     var props (stored properties that differ from the class defaults)
+//     u32 child count, children...
+// Children built from callables or unsaved resources can't be recreated and are left to the builder
+
+void UISnapshot::encode_children(const UI *p_ui, const Ref<StreamPeerBuffer> &p_buf) {
+	// Slotted by node index, which is the order the builder added them in
+	Vector<UI *> ordered;
+	ordered.resize(p_ui->node->get_child_count());
+	ordered.fill(nullptr);
+
+	uint32_t count = 0;
+	for (UI::UITypeCollection::ConstIterator type = p_ui->types.begin(); type; ++type) {
+		for (UI::UIChildrenCollection::ConstIterator child = type->value.children.begin(); child; ++child) {
+			UI *ui = child->value.ptr();
+			if (!ui->inside || ui->type_kind == TYPE_CALLABLE) continue;
+
+			int64_t idx = ui->node->get_index();
+			if (idx < 0 || idx >= ordered.size()) continue;
+
+			ordered.write[idx] = ui;
+			count++;
+		}
+	}
+
+	p_buf->put_u32(count);
+	for (int64_t i = 0; i < ordered.size(); i++) {
+		UI *ui = ordered[i];
+		if (!ui) continue;
+
+		p_buf->put_u8(ui->type_kind);
+		p_buf->put_utf8_string(ui->type_name);
+		p_buf->put_utf8_string(ui->index);
+		p_buf->put_u8(ui->persist ? 1 : 0);
+		p_buf->put_var(encode_props(ui->node));
+		encode_children(ui, p_buf);
+	}
+}
+
+Dictionary UISnapshot::encode_props(Node *p_node) {
+	ClassDBSingleton *db = ClassDBSingleton::get_singleton();
+	StringName class_name = p_node->get_class();
+	TypedArray<Dictionary> list = p_node->get_property_list();
+
+	Dictionary props;
+	for (int64_t i = 0; i < list.size(); i++) {
+		Dictionary info = list[i];
+		if (!((uint32_t)info["usage"] & PROPERTY_USAGE_STORAGE)) continue;
+
+		StringName name = info["name"];
+		if (name == StringName("script")) continue;
+
+		// Object references can't be restored from the snapshot alone, the builder sets them
+		Variant value = p_node->get(name);
+		if (value.get_type() == Variant::OBJECT) continue;
+		if (value == db->class_get_property_default_value(class_name, name)) continue;
+
+		props[name] = value;
+	}
+
+	return props;
+}
+
+void UISnapshot::encode(const UI *p_ui) {
+	Ref<StreamPeerBuffer> buf;
+	buf.instantiate();
+
+	buf->put_u32(MAGIC);
+	buf->put_u16(VERSION);
+	encode_children(p_ui, buf);
+
+	data = buf->get_data_array();
+	decode();
+}
+
+bool UISnapshot::decode_children(const Ref<StreamPeerBuffer> &p_buf, uint32_t p_count, uint32_t p_depth) {
+	#define ENSURE(p_bytes) ERR_FAIL_COND_V_MSG(p_buf->get_available_bytes() < (p_bytes), false, "UI snapshot data is truncated")
+
+	ERR_FAIL_COND_V_MSG(p_depth > UI_SNAPSHOT_MAX_DEPTH, false, "UI snapshot is nested too deep");
+
+	for (uint32_t i = 0; i < p_count; i++) {
+		ENSURE(1);
+		Entry entry;
+		entry.kind = p_buf->get_u8();
+		ERR_FAIL_COND_V_MSG(entry.kind == TYPE_CALLABLE || entry.kind > TYPE_SCRIPT, false, "Invalid UI snapshot type kind");
+		entry.type_name = p_buf->get_utf8_string();
+		entry.index = p_buf->get_utf8_string();
+
+		ENSURE(1);
+		entry.persist = p_buf->get_u8() != 0;
+		Variant props = p_buf->get_var();
+		ERR_FAIL_COND_V_MSG(props.get_type() != Variant::DICTIONARY, false, "Invalid UI snapshot props");
+		entry.props = props;
+
+		ENSURE(4);
+		entry.child_count = p_buf->get_u32();
+
+		int64_t at = entries.size();
+		entries.push_back(entry);
+		if (!decode_children(p_buf, entry.child_count, p_depth + 1)) return false;
+		entries.write[at].descendants = entries.size() - at - 1;
+	}
+
+	#undef ENSURE
+
+	return true;
+}
+
+bool UISnapshot::decode() {
+	entries.clear();
+	resources.clear();
+	root_count = 0;
+
+	if (data.is_empty()) return true;
+
+	Ref<StreamPeerBuffer> buf;
+	buf.instantiate();
+	buf->set_data_array(data);
+
+	ERR_FAIL_COND_V_MSG(buf->get_available_bytes() < 10, false, "UI snapshot data is truncated");
+	ERR_FAIL_COND_V_MSG(buf->get_u32() != MAGIC, false, "Not a UI snapshot");
+	uint16_t version = buf->get_u16();
+	ERR_FAIL_COND_V_MSG(version > VERSION, false, vformat("Unsupported UI snapshot version %d", version));
+
+	root_count = buf->get_u32();
+	return decode_children(buf, root_count, 0);
+}
+
+void UISnapshot::set_data(const PackedByteArray &p_data) {
+	data = p_data;
+	if (!decode()) {
+		entries.clear();
+		root_count = 0;
+	}
+}
+
+void UISnapshot::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_data", "data"), &UISnapshot::set_data);
+	ClassDB::bind_method(D_METHOD("get_data"), &UISnapshot::get_data);
+	ClassDB::bind_method(D_METHOD("get_node_count"), &UISnapshot::get_node_count);
+	ClassDB::add_property("UISnapshot", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE), "set_data", "get_data");
+}
+
+UISnapshot::UISnapshot() {
+	data = PackedByteArray();
+	entries = Vector<Entry>();
+	root_count = 0;
+	resources = Vector<Ref<Resource>>();
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef GODUI_UI_SNAPSHOT_H
+#define GODUI_UI_SNAPSHOT_H
+
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/templates/vector.hpp>
+
+namespace godot {
+
+class UI;
+class StreamPeerBuffer;
+
+class UISnapshot : public Resource {
+	GDCLASS(UISnapshot, Resource);
+
+	friend class UI;
+
+public:
+	enum TypeKind {
+		TYPE_CALLABLE,
+		TYPE_CLASS,
+		TYPE_SCENE,
+		TYPE_SCRIPT,
+	};
+
+private:
+	// Preorder, each entry is followed by its children
+	struct Entry {
+		uint8_t kind;
+		String type_name;
+		String index;
+		bool persist;
+		Dictionary props;
+		uint32_t child_count;
+		uint32_t descendants;
+
+		inline Entry() {
+			kind = TYPE_CALLABLE;
+			type_name = String();
+			index = String();
+			persist = false;
+			props = Dictionary();
+			child_count = 0;
+			descendants = 0;
+		}
+	};
+
+	PackedByteArray data;
+
+	Vector<Entry> entries;
+	uint32_t root_count;
+	// Keeps scenes and scripts loaded so the builder resolves them to the same type keys
+	Vector<Ref<Resource>> resources;
+
+	static void encode_children(const UI *p_ui, const Ref<StreamPeerBuffer> &p_buf);
+	static Dictionary encode_props(Node *p_node);
+
+	void encode(const UI *p_ui);
+	bool decode();
+	bool decode_children(const Ref<StreamPeerBuffer> &p_buf, uint32_t p_count, uint32_t p_depth);
+
+protected:
+	static void _bind_methods();
+
+public:
+	static const uint32_t MAGIC = 0x53554447; // "GDUS"
+	static const uint16_t VERSION = 1;
+
+	void set_data(const PackedByteArray &p_data);
+	inline PackedByteArray get_data() const { return data; }
+
+	inline int get_node_count() const { return entries.size(); }
+
+	UISnapshot();
+};
+
+}
+
+#endif // GODUI_UI_SNAPSHOT_H
\ No newline at end of file
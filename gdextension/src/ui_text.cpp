@@ -0,0 +1,102 @@
+#include "ui_text.h"
+#include "shaped_text_cache.h"
+#include <godot_cpp/classes/text_server.hpp>
+#include <godot_cpp/classes/text_server_manager.hpp>
+
+using namespace godot;
+
+void UIText::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_THEME_CHANGED: {
+			update_minimum_size();
+			queue_redraw();
+		} break;
+		case NOTIFICATION_DRAW: {
+			if (text.is_empty()) return;
+
+			const ShapedTextCache::Entry *entry = ShapedTextCache::get(text, get_theme_font("font"), get_theme_font_size("font_size"), features);
+			if (!entry) return;
+
+			Vector2 size = get_size();
+			Vector2 pos = Vector2(0.0, entry->ascent);
+			switch (horizontal_alignment) {
+				case HORIZONTAL_ALIGNMENT_CENTER: pos.x = (size.x - entry->size.x) * 0.5; break;
+				case HORIZONTAL_ALIGNMENT_RIGHT: pos.x = size.x - entry->size.x; break;
+				default: break;
+			}
+			switch (vertical_alignment) {
+				case VERTICAL_ALIGNMENT_CENTER: pos.y += (size.y - entry->size.y) * 0.5; break;
+				case VERTICAL_ALIGNMENT_BOTTOM: pos.y += size.y - entry->size.y; break;
+				default: break;
+			}
+
+			// The glyphs are recorded straight into this control's canvas item
+			Ref<TextServer> ts = TextServerManager::get_singleton()->get_primary_interface();
+			ts->shaped_text_draw(entry->shaped, get_canvas_item(), pos.round(), -1, -1, get_theme_color("font_color"));
+		} break;
+	}
+}
+
+void UIText::set_text(const String &p_text) {
+	// Rebuilds set the same text every time, only invalidate on real changes
+	if (text == p_text) return;
+	text = p_text;
+	update_minimum_size();
+	queue_redraw();
+}
+
+void UIText::set_features(const Dictionary &p_features) {
+	if (features == p_features) return;
+	features = p_features;
+	update_minimum_size();
+	queue_redraw();
+}
+
+void UIText::set_horizontal_alignment(HorizontalAlignment p_alignment) {
+	if (horizontal_alignment == p_alignment) return;
+	horizontal_alignment = p_alignment;
+	queue_redraw();
+}
+
+void UIText::set_vertical_alignment(VerticalAlignment p_alignment) {
+	if (vertical_alignment == p_alignment) return;
+	vertical_alignment = p_alignment;
+	queue_redraw();
+}
+
+Vector2 UIText::_get_minimum_size() const {
+	Ref<Font> font = get_theme_font("font");
+	int32_t font_size = get_theme_font_size("font_size");
+	if (text.is_empty()) {
+		return font.is_valid() ? Vector2(0.0, font->get_height(font_size)) : Vector2();
+	}
+
+	const ShapedTextCache::Entry *entry = ShapedTextCache::get(text, font, font_size, features);
+	return entry ? entry->size.ceil() : Vector2();
+}
+
+void UIText::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_text", "text"), &UIText::set_text);
+	ClassDB::bind_method(D_METHOD("get_text"), &UIText::get_text);
+	ClassDB::bind_method(D_METHOD("set_features", "features"), &UIText::set_features);
+	ClassDB::bind_method(D_METHOD("get_features"), &UIText::get_features);
+	ClassDB::bind_method(D_METHOD("set_horizontal_alignment", "alignment"), &UIText::set_horizontal_alignment);
+	ClassDB::bind_method(D_METHOD("get_horizontal_alignment"), &UIText::get_horizontal_alignment);
+	ClassDB::bind_method(D_METHOD("set_vertical_alignment", "alignment"), &UIText::set_vertical_alignment);
+	ClassDB::bind_method(D_METHOD("get_vertical_alignment"), &UIText::get_vertical_alignment);
+	ClassDB::add_property("UIText", PropertyInfo(Variant::STRING, "text"), "set_text", "get_text");
+	ClassDB::add_property("UIText", PropertyInfo(Variant::DICTIONARY, "features"), "set_features", "get_features");
+	ClassDB::add_property("UIText", PropertyInfo(Variant::INT, "horizontal_alignment", PROPERTY_HINT_ENUM, "Left,Center,Right,Fill"), "set_horizontal_alignment", "get_horizontal_alignment");
+	ClassDB::add_property("UIText", PropertyInfo(Variant::INT, "vertical_alignment", PROPERTY_HINT_ENUM, "Top,Center,Bottom,Fill"), "set_vertical_alignment", "get_vertical_alignment");
+}
+
+UIText::UIText() {
+	text = String();
+	features = Dictionary();
+	horizontal_alignment = HORIZONTAL_ALIGNMENT_LEFT;
+	vertical_alignment = VERTICAL_ALIGNMENT_CENTER;
+
+	// Picks up the Label theme items, overrides on this node still take precedence
+	set_theme_type_variation("Label");
+	set_mouse_filter(MOUSE_FILTER_IGNORE);
+}
\ No newline at end of file
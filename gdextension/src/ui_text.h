@@ -0,0 +1,44 @@
+#ifndef GODUI_UI_TEXT_H
+#define GODUI_UI_TEXT_H
+
+#include <godot_cpp/classes/control.hpp>
+#include <godot_cpp/classes/font.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+namespace godot {
+
+// Single line text drawn from the shared shaped text cache, without the per node buffers of a Label
+class UIText : public Control {
+	GDCLASS(UIText, Control);
+
+	String text;
+	Dictionary features;
+	HorizontalAlignment horizontal_alignment;
+	VerticalAlignment vertical_alignment;
+
+protected:
+	static void _bind_methods();
+
+	void _notification(int p_what);
+
+public:
+	void set_text(const String &p_text);
+	inline String get_text() const { return text; }
+
+	void set_features(const Dictionary &p_features);
+	inline Dictionary get_features() const { return features; }
+
+	void set_horizontal_alignment(HorizontalAlignment p_alignment);
+	inline HorizontalAlignment get_horizontal_alignment() const { return horizontal_alignment; }
+
+	void set_vertical_alignment(VerticalAlignment p_alignment);
+	inline VerticalAlignment get_vertical_alignment() const { return vertical_alignment; }
+
+	virtual Vector2 _get_minimum_size() const override;
+
+	UIText();
+};
+
+}
+
+#endif // GODUI_UI_TEXT_H
\ No newline at end of file
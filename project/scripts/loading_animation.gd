@@ -16,12 +16,6 @@ func _notification(what: int) -> void:
 	# Notify the interface from the Node's notification
 	if ui: ui.notification(what)
 
-## Draws an arc with caps
-func draw_capped_arc(node: CanvasItem, center: Vector2, radius: float, start: float, end: float, point_count: int, color: Color, width: float) -> void:
-	node.draw_arc(center, radius, start, end, point_count, color, width, true)
-	node.draw_circle(center + Vector2(radius, 0.0).rotated(end), width * 0.5, color)
-	node.draw_circle(center + Vector2(radius, 0.0).rotated(start), width * 0.5, color)
-
 ## Called to update the interface
 func ui_process(ui: UI) -> void:
 	# "draw" allows to directly draw something in the node
@@ -54,9 +48,12 @@ func ui_process(ui: UI) -> void:
 		# Animate arc rotation
 		var rot: float = time * TAU / 1.0
 
-		# Draw an arc with both caps
-		draw_capped_arc(node, size * 0.5, rad - 4.0, rot + a0, rot + a1, 32, Color.RED, width)
+		# Draw an arc with both caps, it's tessellated natively and
+		# submitted to the renderer in a single call
+		draw.capped_arc(size * 0.5, rad - 4.0, rot + a0, rot + a1, 32, Color.RED, width, true)
 		
 		# Call "redraw" to request to draw again
 		draw.redraw()
-	)
+	# A spinner doesn't need more than 30 redraws per second, and shouldn't
+	# redraw at all while hidden, scrolled away or the window is unfocused
+	).draw_policy(30.0)
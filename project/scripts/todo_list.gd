@@ -97,8 +97,9 @@ func show_task(ui: UI, task: Dictionary) -> void:
 			if task.completed:
 				# Let's animate two properties parallely
 				motion.parallel(func (motion):
-					# Let's animate the `rotation` property
-					motion.prop("rotation")
+					# Let's animate the visual `rotation` channel, it only changes how
+					# the checkbox is drawn and never invalidates the layout
+					motion.visual("rotation")
 
 					# Start from the node's current rotation
 					motion.from_current()
@@ -107,8 +108,8 @@ func show_task(ui: UI, task: Dictionary) -> void:
 					# easing out transition
 					motion.ease_out(TAU, 0.5)
 
-					# Let's also animate the `scale` property
-					motion.prop("scale")
+					# Let's also animate the visual `scale` channel
+					motion.visual("scale")
 
 					# Start from the node's current scale
 					motion.from_current()
@@ -119,20 +120,21 @@ func show_task(ui: UI, task: Dictionary) -> void:
 				)
 
 				# After above parallel animation finishes, let's animate scale
-				motion.prop("scale")
+				motion.visual("scale")
 
 				# Scale to 1.0 during 500 milliseconds using
 				# easing in-out transition
 				motion.ease_in_out(Vector2(1.0, 1.0), 0.5)
 
 				# Also snap rotation back to zero (it's the same as 360)
-				motion.prop("rotation").frame(0.0)
+				motion.visual("rotation").frame(0.0)
 			# Rotates and scales back to zero when not completed
 			else:
 				# Let's animate two properties parallely
 				motion.parallel(func (motion):
-					# Let's animate the `rotation` property
-					motion.prop("rotation")
+					# Let's animate the visual `rotation` channel, it only changes how
+					# the checkbox is drawn and never invalidates the layout
+					motion.visual("rotation")
 
 					# Start from the node's current rotation
 					motion.from_current()
@@ -141,8 +143,8 @@ func show_task(ui: UI, task: Dictionary) -> void:
 					# easing in-out transition
 					motion.ease_in_out(0.0, 0.5)
 
-					# Let's also animate the `scale` property
-					motion.prop("scale")
+					# Let's also animate the visual `scale` channel
+					motion.visual("scale")
 
 					# Start from the node's current scale
 					motion.from_current()
@@ -169,6 +171,27 @@ func show_task(ui: UI, task: Dictionary) -> void:
 		# Lastly a button to delete the task
 		var task_delete_ui: UI = task_panel.button("delete")
 
+		# Set the button's pivot_offset to center so it grows from the middle
+		task_delete_ui.prop("pivot_offset", task_delete_ui.ref().size * 0.5)
+
+		# Store the delete button motion reference to retarget it when hovered
+		var task_delete_motion: Dictionary = {"ref": null}
+
+		# Springs keep their value and velocity between updates, so their target
+		# can be changed at any time without updating the UI or restarting anything
+		task_delete_ui.motion(func (motion: MotionRef):
+			task_delete_motion.ref = motion
+			motion.visual("scale").spring(Vector2(1.1, 1.1) if task_delete_ui.ref().is_hovered() else Vector2.ONE)
+		)
+
+		# Grow the button while hovered and shrink back when the mouse leaves
+		task_delete_ui.event("mouse_entered", func ():
+			task_delete_motion.ref.visual("scale").spring(Vector2(1.1, 1.1))
+		)
+		task_delete_ui.event("mouse_exited", func ():
+			task_delete_motion.ref.visual("scale").spring(Vector2.ONE)
+		)
+
 		# Connect the `pressed` signal to delete the task when pressed
 		task_delete_ui.event("pressed", func ():
 			# Delete the task from ID